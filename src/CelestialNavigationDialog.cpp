@@ -96,7 +96,10 @@ CelestialNavigationDialog::CelestialNavigationDialog(
     : CelestialNavigationDialogBase(parent),
       m_ClockCorrectionDialog(NULL),
       m_FixDialog(NULL),
-      m_Plugin(ppi) {
+      m_PreviewSight(NULL),
+      m_Plugin(ppi),
+      m_bFixPending(false),
+      m_RebuildTickets(0) {
   wxFileConfig* pConf = GetOCPNConfigObject();
 
   pConf->SetPath(_T("/PlugIns/CelestialNavigation"));
@@ -302,16 +305,13 @@ bool CelestialNavigationDialog::OpenXML(bool reportfailure) {
         s.m_bCalculated = false;
         s.m_bSelected = false;
 
-        if (s.m_bVisible) {
-          s.Recompute(m_ClockCorrection);
-          s.RebuildPolygons();
-        }
         m_Sights.push_back(std::move(s));
       } else
         FAIL(_("Unrecognized xml node"));
     }
   }
 
+  RecomputeSights();
   RebuildList();
   m_lSights->SetColumnWidth(0, 28);
   for (int i = 1; i < rmMAX; i++) {
@@ -451,10 +451,47 @@ bool compareSight(const Sight& a, const Sight& b, int sortCol, bool sortAsc) {
                  : !compareSightAsc(a, b, sortCol);
 }
 
+/* recompute every visible sight and rebuild its line of position on the
+   worker pool, one job per sight, replacing the jobs of any earlier call.
+   The list may be sorted or edited before a job finishes, so each sight
+   carries the ticket of its job and takes the geometry posted back with
+   that ticket, unless it has been rebuilt in the meantime */
+void CelestialNavigationDialog::RecomputeSights() {
+  m_Computations.clear();
+
+  for (Sight& s : m_Sights) {
+    s.m_RebuildTicket = 0;
+    if (!s.m_bVisible) continue;
+
+    s.Recompute(m_ClockCorrection);
+
+    unsigned int ticket = ++m_RebuildTickets;
+    s.m_RebuildTicket = ticket;
+    m_Computations.emplace_back(new SightComputation(this, m_Workers));
+    m_Computations.back()->Submit(
+        s, [this, ticket](const SightGeometry& geometry, bool complete) {
+          OnSightComputed(ticket, geometry, complete);
+        });
+  }
+}
+
+void CelestialNavigationDialog::OnSightComputed(unsigned int ticket,
+                                                const SightGeometry& geometry,
+                                                bool complete) {
+  for (Sight& s : m_Sights)
+    if (s.m_RebuildTicket == ticket) {
+      s.SetGeometry(geometry);
+      if (complete) s.m_RebuildTicket = 0;
+    }
+
+  RequestRefresh(GetParent());
+}
+
 void CelestialNavigationDialog::RebuildList() {
   using namespace std::placeholders;
   std::sort(m_Sights.begin(), m_Sights.end(),
             std::bind(compareSight, _1, _2, m_sortCol, m_bSortAsc));
+  m_Plugin->ClearHover();
 
 #if wxCHECK_VERSION(3, 1, 6)
   m_lSights->ShowSortIndicator(m_sortCol, m_bSortAsc);
@@ -506,6 +543,21 @@ void CelestialNavigationDialog::RebuildList() {
 }
 
 void CelestialNavigationDialog::UpdateSight(int idx) {
+  UpdateItem(idx);
+  UpdateButtons();
+  UpdateFix();
+  SaveXML();
+}
+
+/* one solve and save for the lot rather than one per sight */
+void CelestialNavigationDialog::UpdateSights() {
+  for (int i = 0; i < m_lSights->GetItemCount(); i++) UpdateItem(i);
+  UpdateButtons();
+  UpdateFix();
+  SaveXML();
+}
+
+void CelestialNavigationDialog::UpdateItem(int idx) {
   Sight& s = m_Sights[idx];
 
   // then add sights to the listctrl
@@ -522,14 +574,6 @@ void CelestialNavigationDialog::UpdateSight(int idx) {
                            wxString::Format(_T(": %ld s"), s.m_TimeCorrection));
   else
     m_lSights->SetItem(idx, rmCOLOR, s.m_ColourName);
-
-  UpdateButtons();
-  UpdateFix();
-  SaveXML();
-}
-
-void CelestialNavigationDialog::UpdateSights() {
-  for (int i = 0; i < m_lSights->GetItemCount(); i++) UpdateSight(i);
 }
 
 void CelestialNavigationDialog::UpdateButtons() {
@@ -544,22 +588,32 @@ void CelestialNavigationDialog::UpdateButtons() {
   m_bDeleteSight->Enable(enable);
 }
 
+/* the fix and the track estimate follow the sights, once a batch of edits
+   is done */
 void CelestialNavigationDialog::UpdateFix() {
-  if (m_FixDialog) m_FixDialog->Update(m_ClockCorrection);
+  if (m_bFixPending) return;
+
+  m_bFixPending = true;
+  CallAfter([this] {
+    m_bFixPending = false;
+    m_Plugin->UpdateTrack(m_Sights, m_ClockCorrection);
+    if (m_FixDialog) m_FixDialog->Update(m_ClockCorrection);
+  });
 }
 
 void CelestialNavigationDialog::OnNew(wxCommandEvent& event) {
   wxDateTime now = wxDateTime::Now().ToUTC();
 
   Sight ns(Sight::ALTITUDE, _("Sun"), Sight::LOWER, now, 0, 0, 10);
-  SightDialog dialog(this, ns, m_ClockCorrection);
+  SightDialog dialog(this, ns, m_ClockCorrection, m_Workers);
 
+  m_PreviewSight = &ns;
   dialog.ShowModal();
+  m_PreviewSight = NULL;
   if (dialog.GetReturnCode() == wxID_OK) {
-    if (ns.m_bVisible) {
-      dialog.Recompute();
-      ns.RebuildPolygons();
-    }
+    /* every change was recomputed as it was made, so only a rebuild still
+       running needs finishing */
+    if (ns.m_bVisible && !dialog.Complete()) ns.RebuildPolygons();
     ns.SetSelected(true);
     for (Sight& s : m_Sights) s.SetSelected(false);
     m_Sights.push_back(std::move(ns));
@@ -594,14 +648,15 @@ void CelestialNavigationDialog::OnEdit() {
   Sight& s = m_Sights[selectedIndex];
   Sight originalsight = s; /* in case of cancel */
 
-  SightDialog dialog(this, s, m_ClockCorrection);
+  /* a background rebuild still running is for the sight as it was, the
+     dialog recomputes the edits itself */
+  s.m_RebuildTicket = 0;
+
+  SightDialog dialog(this, s, m_ClockCorrection, m_Workers);
 
   dialog.ShowModal();
   if (dialog.GetReturnCode() == wxID_OK) {
-    if (s.m_bVisible) {
-      dialog.Recompute();
-      s.RebuildPolygons();
-    }
+    if (s.m_bVisible && !dialog.Complete()) s.RebuildPolygons();
     UpdateSight(selectedIndex);
     RebuildList();
   } else
@@ -610,6 +665,37 @@ void CelestialNavigationDialog::OnEdit() {
   RequestRefresh(GetParent());
 }
 
+/* select a sight in the list as if it was clicked there */
+void CelestialNavigationDialog::SelectSight(int idx) {
+  if (idx < 0 || idx >= m_lSights->GetItemCount()) return;
+
+  for (int i = 0; i < m_lSights->GetItemCount(); i++)
+    m_lSights->SetItemState(i, i == idx ? wxLIST_STATE_SELECTED : 0,
+                            wxLIST_STATE_SELECTED);
+  m_lSights->EnsureVisible(idx);
+
+  for (Sight& s : m_Sights) s.SetSelected(false);
+  m_Sights[idx].SetSelected(true);
+  UpdateButtons();
+}
+
+void CelestialNavigationDialog::EditSight(int idx) {
+  if (idx < 0 || idx >= m_lSights->GetItemCount()) return;
+
+  SelectSight(idx);
+  OnEdit();
+}
+
+/* sights the fix rejected are listed in red */
+void CelestialNavigationDialog::MarkOutliers(
+    const std::vector<bool>& outliers) {
+  for (int i = 0; i < m_lSights->GetItemCount(); i++) {
+    bool outlier = i < (int)outliers.size() && outliers[i];
+    m_lSights->SetItemTextColour(i,
+                                 outlier ? *wxRED : m_lSights->GetTextColour());
+  }
+}
+
 void CelestialNavigationDialog::OnDelete(wxCommandEvent& event) {
   // Delete selectedIndex sight/track
   long selectedIndex =
@@ -618,6 +704,7 @@ void CelestialNavigationDialog::OnDelete(wxCommandEvent& event) {
 
   m_lSights->DeleteItem(selectedIndex);
   m_Sights.erase(m_Sights.begin() + selectedIndex);
+  m_Plugin->ClearHover();
   if ((selectedIndex >= m_lSights->GetItemCount()) && (selectedIndex > 0))
     selectedIndex--;
   if (m_lSights->GetItemCount() > 0) {
@@ -635,6 +722,7 @@ void CelestialNavigationDialog::OnDeleteAll(wxCommandEvent& event) {
   if (mdlg.ShowModal() == wxID_YES) {
     m_lSights->DeleteAllItems();
     m_Sights.clear();
+    m_Plugin->ClearHover();
     SaveXML();
     RequestRefresh(GetParent());
   }
@@ -650,6 +738,7 @@ void CelestialNavigationDialog::OnFix(wxCommandEvent& event) {
 }
 
 void CelestialNavigationDialog::OnFixClose() {
+  MarkOutliers(std::vector<bool>());
   m_FixDialog->Hide();
   m_FixDialog->Destroy();
   m_FixDialog = NULL;
@@ -679,20 +768,20 @@ void CelestialNavigationDialog::OnClockOffset(wxCommandEvent& event) {
   m_ClockCorrectionDialog = new ClockCorrectionDialog(this, m_ClockCorrection);
   m_ClockCorrectionDialog->ShowModal();
   if (m_ClockCorrectionDialog->GetReturnCode() == wxID_OK) {
-    m_ClockCorrection = m_ClockCorrectionDialog->m_sClockCorrection->GetValue();
-    for (Sight& s : m_Sights) {
-      if (s.m_bVisible) {
-        s.Recompute(m_ClockCorrection);
-        s.RebuildPolygons();
-      }
-    }
-    UpdateSights();
-    RequestRefresh(GetParent());
+    SetClockCorrection(
+        m_ClockCorrectionDialog->m_sClockCorrection->GetValue());
   }
   m_ClockCorrectionDialog->Destroy();
   m_ClockCorrectionDialog = NULL;
 }
 
+void CelestialNavigationDialog::SetClockCorrection(int seconds) {
+  m_ClockCorrection = seconds;
+  RecomputeSights();
+  UpdateSights();
+  RequestRefresh(GetParent());
+}
+
 void CelestialNavigationDialog::OnDocumentation(wxCommandEvent& event) {
   wxString infolocation = celestial_navigation_pi_DataDir() + _T("/data/") +
                           _T("Celestial_Navigation_Information.html");
@@ -29,12 +29,15 @@
 #define _CelestialNavigationDialog_h_
 
 #include <list>
+#include <memory>
 
 #include "celestial_navigation_pi.h"
 #include "geodesic.h"
 #include "CelestialNavigationUI.h"
 #include "FixDialog.h"
 #include "ClockCorrectionDialog.h"
+#include "SightWorkerPool.h"
+#include "SightComputation.h"
 
 #include <vector>
 
@@ -47,11 +50,17 @@ public:
   CelestialNavigationDialog(wxWindow* parent, celestial_navigation_pi* ppi);
   ~CelestialNavigationDialog();
   void UpdateSights();
+  void SelectSight(int idx);
+  void EditSight(int idx);
+  void MarkOutliers(const std::vector<bool>& outliers);
+  void SetClockCorrection(int seconds);
 
   ClockCorrectionDialog* m_ClockCorrectionDialog;
   FixDialog* m_FixDialog;
   double m_pix_per_mm;
   std::vector<Sight> m_Sights;
+  Sight* m_PreviewSight;  // new sight being edited, not yet in m_Sights
+  SightRenderStats m_RenderStats;  // drawn and culled in the last frame
 
   void OnFixClose();
 
@@ -59,6 +68,9 @@ private:
   bool OpenXML(bool reportfailure);
   void SaveXML();
 
+  void RecomputeSights();
+  void OnSightComputed(unsigned int ticket, const SightGeometry& geometry,
+                       bool complete);
   void RebuildList();
   void UpdateButtons();  // Correct button state
   void UpdateFix();
@@ -91,6 +103,7 @@ private:
 
   void InsertSight(Sight* s);
   void UpdateSight(int idx);
+  void UpdateItem(int idx);  // list text only
 
   celestial_navigation_pi* m_Plugin;
   wxString m_sights_path;
@@ -104,6 +117,13 @@ private:
 
   int m_lastPanX;
   int m_lastPanY;
+
+  bool m_bFixPending;  // UpdateFix has a solve queued
+  SightWorkerPool m_Workers;
+
+  /* rebuilds started by RecomputeSights, one per visible sight */
+  std::vector<std::unique_ptr<SightComputation>> m_Computations;
+  unsigned int m_RebuildTickets;
 };
 
 #endif  // _CelestialNavigationDialog_h_
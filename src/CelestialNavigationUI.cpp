@@ -1065,6 +1065,7 @@ FixDialogBase::FixDialogBase( wxWindow* parent, wxWindowID id, const wxString& t
 	m_cbFixAlgorithm->Append( _("Sphere") );
 	m_cbFixAlgorithm->Append( _("Cone") );
 	m_cbFixAlgorithm->Append( _("Cone 2") );
+	m_cbFixAlgorithm->Append( _("Robust") );
 	m_cbFixAlgorithm->SetSelection( 1 );
 	fgSizer16->Add( m_cbFixAlgorithm, 0, wxALL|wxEXPAND, 5 );
 
@@ -1073,6 +1074,51 @@ FixDialogBase::FixDialogBase( wxWindow* parent, wxWindowID id, const wxString& t
 
 	fgSizer16->Add( m_bGo, 0, wxALL|wxEXPAND, 5 );
 
+	m_cbSolveClock = new wxCheckBox( sbSizer7->GetStaticBox(), wxID_ANY, _("Clock"), wxDefaultPosition, wxDefaultSize, 0 );
+	fgSizer16->Add( m_cbSolveClock, 0, wxALIGN_CENTER_VERTICAL|wxALL|wxEXPAND, 5 );
+
+	m_stClockCorrection = new wxTextCtrl( sbSizer7->GetStaticBox(), wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxTE_READONLY );
+	fgSizer16->Add( m_stClockCorrection, 0, wxALL|wxEXPAND, 5 );
+
+	m_bApplyClock = new wxButton( sbSizer7->GetStaticBox(), wxID_ANY, _("Apply"), wxDefaultPosition, wxSize( -1,-1 ), wxBU_EXACTFIT );
+	m_bApplyClock->Enable( false );
+
+	fgSizer16->Add( m_bApplyClock, 0, wxALL|wxEXPAND, 5 );
+
+	m_cbResiduals = new wxCheckBox( sbSizer7->GetStaticBox(), wxID_ANY, _("Residuals"), wxDefaultPosition, wxDefaultSize, 0 );
+	fgSizer16->Add( m_cbResiduals, 0, wxALIGN_CENTER_VERTICAL|wxALL|wxEXPAND, 5 );
+
+	m_cbMonteCarlo = new wxCheckBox( sbSizer7->GetStaticBox(), wxID_ANY, _("Monte Carlo"), wxDefaultPosition, wxDefaultSize, 0 );
+	fgSizer16->Add( m_cbMonteCarlo, 0, wxALIGN_CENTER_VERTICAL|wxALL|wxEXPAND, 5 );
+
+	m_stMonteCarlo = new wxTextCtrl( sbSizer7->GetStaticBox(), wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxTE_READONLY );
+	fgSizer16->Add( m_stMonteCarlo, 0, wxALL|wxEXPAND, 5 );
+
+
+	fgSizer16->Add( 0, 0, 0, wxALL|wxEXPAND, 5 );
+
+	m_staticText37 = new wxStaticText( sbSizer7->GetStaticBox(), wxID_ANY, _("Candidates"), wxDefaultPosition, wxDefaultSize, 0 );
+	m_staticText37->Wrap( -1 );
+	fgSizer16->Add( m_staticText37, 0, wxALIGN_CENTER_VERTICAL|wxALL|wxEXPAND, 5 );
+
+	wxArrayString m_cCandidatesChoices;
+	m_cCandidates = new wxChoice( sbSizer7->GetStaticBox(), wxID_ANY, wxDefaultPosition, wxDefaultSize, m_cCandidatesChoices, 0 );
+	m_cCandidates->SetSelection( 0 );
+	fgSizer16->Add( m_cCandidates, 0, wxALL|wxEXPAND, 5 );
+
+	m_cbCockedHat = new wxCheckBox( sbSizer7->GetStaticBox(), wxID_ANY, _("Cocked Hat"), wxDefaultPosition, wxDefaultSize, 0 );
+	fgSizer16->Add( m_cbCockedHat, 0, wxALIGN_CENTER_VERTICAL|wxALL|wxEXPAND, 5 );
+
+	m_stCockedHat = new wxTextCtrl( sbSizer7->GetStaticBox(), wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxTE_READONLY );
+	fgSizer16->Add( m_stCockedHat, 0, wxALL|wxEXPAND, 5 );
+
+	m_staticText38 = new wxStaticText( sbSizer7->GetStaticBox(), wxID_ANY, _("DR Error (nm)"), wxDefaultPosition, wxDefaultSize, 0 );
+	m_staticText38->Wrap( -1 );
+	fgSizer16->Add( m_staticText38, 0, wxALIGN_CENTER_VERTICAL|wxALL|wxEXPAND, 5 );
+
+	m_sClockCertainty = new wxSpinCtrl( sbSizer7->GetStaticBox(), wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize( -1,-1 ), wxSP_ARROW_KEYS, 0, 100, 2 );
+	fgSizer16->Add( m_sClockCertainty, 0, wxALL|wxEXPAND, 5 );
+
 
 	sbSizer7->Add( fgSizer16, 1, wxEXPAND, 5 );
 
@@ -1098,6 +1144,13 @@ FixDialogBase::FixDialogBase( wxWindow* parent, wxWindowID id, const wxString& t
 	m_sInitialLongitude->Connect( wxEVT_COMMAND_SPINCTRL_UPDATED, wxSpinEventHandler( FixDialogBase::OnUpdateSpin ), NULL, this );
 	m_cbFixAlgorithm->Connect( wxEVT_COMMAND_COMBOBOX_SELECTED, wxCommandEventHandler( FixDialogBase::OnUpdate ), NULL, this );
 	m_bGo->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( FixDialogBase::OnGo ), NULL, this );
+	m_cbSolveClock->Connect( wxEVT_COMMAND_CHECKBOX_CLICKED, wxCommandEventHandler( FixDialogBase::OnUpdate ), NULL, this );
+	m_bApplyClock->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( FixDialogBase::OnApplyClock ), NULL, this );
+	m_cbResiduals->Connect( wxEVT_COMMAND_CHECKBOX_CLICKED, wxCommandEventHandler( FixDialogBase::OnUpdate ), NULL, this );
+	m_cbMonteCarlo->Connect( wxEVT_COMMAND_CHECKBOX_CLICKED, wxCommandEventHandler( FixDialogBase::OnUpdate ), NULL, this );
+	m_cCandidates->Connect( wxEVT_COMMAND_CHOICE_SELECTED, wxCommandEventHandler( FixDialogBase::OnCandidate ), NULL, this );
+	m_cbCockedHat->Connect( wxEVT_COMMAND_CHECKBOX_CLICKED, wxCommandEventHandler( FixDialogBase::OnUpdate ), NULL, this );
+	m_sClockCertainty->Connect( wxEVT_COMMAND_SPINCTRL_UPDATED, wxSpinEventHandler( FixDialogBase::OnUpdateSpin ), NULL, this );
 	m_sdbSizer8OK->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( FixDialogBase::OnClose ), NULL, this );
 }
 
@@ -1108,6 +1161,13 @@ FixDialogBase::~FixDialogBase()
 	m_sInitialLongitude->Disconnect( wxEVT_COMMAND_SPINCTRL_UPDATED, wxSpinEventHandler( FixDialogBase::OnUpdateSpin ), NULL, this );
 	m_cbFixAlgorithm->Disconnect( wxEVT_COMMAND_COMBOBOX_SELECTED, wxCommandEventHandler( FixDialogBase::OnUpdate ), NULL, this );
 	m_bGo->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( FixDialogBase::OnGo ), NULL, this );
+	m_cbSolveClock->Disconnect( wxEVT_COMMAND_CHECKBOX_CLICKED, wxCommandEventHandler( FixDialogBase::OnUpdate ), NULL, this );
+	m_bApplyClock->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( FixDialogBase::OnApplyClock ), NULL, this );
+	m_cbResiduals->Disconnect( wxEVT_COMMAND_CHECKBOX_CLICKED, wxCommandEventHandler( FixDialogBase::OnUpdate ), NULL, this );
+	m_cbMonteCarlo->Disconnect( wxEVT_COMMAND_CHECKBOX_CLICKED, wxCommandEventHandler( FixDialogBase::OnUpdate ), NULL, this );
+	m_cCandidates->Disconnect( wxEVT_COMMAND_CHOICE_SELECTED, wxCommandEventHandler( FixDialogBase::OnCandidate ), NULL, this );
+	m_cbCockedHat->Disconnect( wxEVT_COMMAND_CHECKBOX_CLICKED, wxCommandEventHandler( FixDialogBase::OnUpdate ), NULL, this );
+	m_sClockCertainty->Disconnect( wxEVT_COMMAND_SPINCTRL_UPDATED, wxSpinEventHandler( FixDialogBase::OnUpdateSpin ), NULL, this );
 	m_sdbSizer8OK->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( FixDialogBase::OnClose ), NULL, this );
 
 }
@@ -327,6 +327,18 @@ class FixDialogBase : public wxDialog
 		wxStaticText* m_staticText36;
 		wxComboBox* m_cbFixAlgorithm;
 		wxButton* m_bGo;
+		wxCheckBox* m_cbSolveClock;
+		wxTextCtrl* m_stClockCorrection;
+		wxButton* m_bApplyClock;
+		wxCheckBox* m_cbResiduals;
+		wxCheckBox* m_cbMonteCarlo;
+		wxTextCtrl* m_stMonteCarlo;
+		wxStaticText* m_staticText37;
+		wxChoice* m_cCandidates;
+		wxCheckBox* m_cbCockedHat;
+		wxTextCtrl* m_stCockedHat;
+		wxStaticText* m_staticText38;
+		wxSpinCtrl* m_sClockCertainty;
 		wxStdDialogButtonSizer* m_sdbSizer8;
 		wxButton* m_sdbSizer8OK;
 
@@ -334,6 +346,8 @@ class FixDialogBase : public wxDialog
 		virtual void OnUpdateSpin( wxSpinEvent& event ) { event.Skip(); }
 		virtual void OnUpdate( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnGo( wxCommandEvent& event ) { event.Skip(); }
+		virtual void OnApplyClock( wxCommandEvent& event ) { event.Skip(); }
+		virtual void OnCandidate( wxCommandEvent& event ) { event.Skip(); }
 		virtual void OnClose( wxCommandEvent& event ) { event.Skip(); }
 
 
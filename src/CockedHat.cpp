@@ -0,0 +1,283 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+
+#include "CockedHat.h"
+#include "celestial_navigation_pi.h"
+
+/* lines crossing at a smaller angle in degrees are left out of the hat,
+   where the least error in either moves their crossing far along them */
+static const double s_MinCut = 15;
+
+/* a crossing this close to another line, in the sine of the altitude, is
+   taken to be on it, a few millimeters */
+static const double s_OnLine = 1e-9;
+
+static double dot3(const double a[3], const double b[3]) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static double det3(const double M[3][3]) {
+  return M[0][0] * (M[1][1] * M[2][2] - M[1][2] * M[2][1]) -
+         M[0][1] * (M[1][0] * M[2][2] - M[1][2] * M[2][0]) +
+         M[0][2] * (M[1][0] * M[2][1] - M[1][1] * M[2][0]);
+}
+
+/* index of the pair i < j of n sights */
+static int Pair(int i, int j, int n) {
+  return i * (2 * n - i - 1) / 2 + j - i - 1;
+}
+
+CockedHat::CockedHat() { Clear(); }
+
+void CockedHat::Clear() {
+  m_Contributions.clear();
+  m_Pairs.clear();
+  m_Hat.clear();
+  m_Crossings = m_Computed = 0;
+  m_Area = 0;
+  m_InscribedLat = m_InscribedLon = m_InscribedRadius = NAN;
+}
+
+/* the points p with p.ga = a.sm and p.gb = b.sm on the unit sphere are
+   p = ka ga + kb gb + t ga x gb, the first two terms fixed by the
+   altitudes and t by the length */
+CockedHat::Crossing CockedHat::Cross(const FixContribution& a,
+                                     const FixContribution& b) {
+  Crossing k;
+  k.valid = false;
+  double ga[3] = {a.x, a.y, a.z}, gb[3] = {b.x, b.y, b.z};
+  double c = dot3(ga, gb), d = 1 - c * c;
+  if (!(d > 1e-12)) return k;  // the same or opposite positions
+
+  double ka = (a.sm - b.sm * c) / d, kb = (b.sm - a.sm * c) / d;
+  double t2 = (1 - (ka * a.sm + kb * b.sm)) / d;
+  if (t2 < 0) return k;  // the circles miss each other
+  double t = sqrt(t2);
+
+  double n[3] = {ga[1] * gb[2] - ga[2] * gb[1], ga[2] * gb[0] - ga[0] * gb[2],
+                 ga[0] * gb[1] - ga[1] * gb[0]};
+  for (int i = 0; i < 3; i++) {
+    k.p[0][i] = ka * ga[i] + kb * gb[i] + t * n[i];
+    k.p[1][i] = ka * ga[i] + kb * gb[i] - t * n[i];
+  }
+
+  /* the lines cross at the angle between the directions to the two
+     positions, the same at both points */
+  double ta[3], tb[3], pa = dot3(ga, k.p[0]), pb = dot3(gb, k.p[0]);
+  for (int i = 0; i < 3; i++) {
+    ta[i] = ga[i] - pa * k.p[0][i];
+    tb[i] = gb[i] - pb * k.p[0][i];
+  }
+  double cc = dot3(ta, tb) / sqrt(dot3(ta, ta) * dot3(tb, tb));
+  k.cut = fabs(cc);
+  k.valid = true;
+  return k;
+}
+
+void CockedHat::Update(const std::vector<FixContribution>& contributions,
+                       double lat, double lon) {
+  /* sights from the last update, found by what the crossings depend on */
+  std::map<std::array<double, 4>, int> previous;
+  for (size_t i = 0; i < m_Contributions.size(); i++) {
+    const FixContribution& c = m_Contributions[i];
+    previous[{{c.x, c.y, c.z, c.sm}}] = i;
+  }
+  int n = contributions.size(), m = m_Contributions.size();
+  std::vector<int> was(n, -1);
+  for (int i = 0; i < n; i++) {
+    const FixContribution& c = contributions[i];
+    auto it = previous.find({{c.x, c.y, c.z, c.sm}});
+    if (it != previous.end()) was[i] = it->second;
+  }
+
+  std::vector<Crossing> pairs(n * (n - 1) / 2);
+  m_Computed = 0;
+  for (int i = 0; i < n; i++)
+    for (int j = i + 1; j < n; j++) {
+      int oi = was[i], oj = was[j];
+      if (oi >= 0 && oj >= 0 && oi != oj)
+        pairs[Pair(i, j, n)] =
+            m_Pairs[Pair(std::min(oi, oj), std::max(oi, oj), m)];
+      else {
+        pairs[Pair(i, j, n)] = Cross(contributions[i], contributions[j]);
+        m_Computed++;
+      }
+    }
+  m_Pairs.swap(pairs);
+  m_Contributions = contributions;
+
+  /* the crossings nearer the fix on the plane touching the earth there.
+     The gnomonic projection keeps the hat's sides, nearly great circles
+     over a few miles, straight */
+  double slat = sin(d_to_r(lat)), clat = cos(d_to_r(lat));
+  double slon = sin(d_to_r(lon)), clon = cos(d_to_r(lon));
+  double P[3] = {clat * clon, clat * slon, slat};
+  double E[3] = {-slon, clon, 0};
+  double N[3] = {-slat * clon, -slat * slon, clat};
+
+  /* the side of each line the fix is on, inside its circle or out */
+  std::vector<double> side(n);
+  for (int i = 0; i < n; i++) {
+    const FixContribution& c = contributions[i];
+    side[i] = c.x * P[0] + c.y * P[1] + c.z * P[2] >= c.sm ? 1 : -1;
+  }
+
+  /* the hat is the cell of the lines that holds the fix, so a crossing is
+     one of its corners when it is on the fix's side of every other line.
+     With more than three lines the other crossings fall outside it */
+  std::vector<std::pair<double, double>> points;
+  double mincut = cos(d_to_r(s_MinCut));
+  m_Crossings = 0;
+  for (int i = 0; i < n; i++)
+    for (int j = i + 1; j < n; j++) {
+      const Crossing& k = m_Pairs[Pair(i, j, n)];
+      if (!k.valid) continue;
+      m_Crossings++;
+      const double* p = dot3(k.p[0], P) > dot3(k.p[1], P) ? k.p[0] : k.p[1];
+      double d = dot3(p, P);
+      if (d <= 0 || k.cut > mincut) continue;
+
+      bool inside = true;
+      for (int l = 0; l < n && inside; l++) {
+        if (l == i || l == j) continue;
+        const FixContribution& c = contributions[l];
+        double r = c.x * p[0] + c.y * p[1] + c.z * p[2] - c.sm;
+        inside = side[l] * r > -s_OnLine;
+      }
+      if (inside)
+        points.push_back(std::make_pair(dot3(p, E) / d, dot3(p, N) / d));
+    }
+
+  /* in order around the cell by Andrew's monotone chain, counterclockwise */
+  std::sort(points.begin(), points.end());
+  points.erase(std::unique(points.begin(), points.end()), points.end());
+  std::vector<std::pair<double, double>> hull;
+  if (points.size() < 3)
+    hull = points;
+  else {
+    hull.resize(2 * points.size());
+    auto turn = [](const std::pair<double, double>& o,
+                   const std::pair<double, double>& a,
+                   const std::pair<double, double>& b) {
+      return (a.first - o.first) * (b.second - o.second) -
+             (a.second - o.second) * (b.first - o.first);
+    };
+    int k = 0;
+    for (size_t i = 0; i < points.size(); i++) {
+      while (k >= 2 && turn(hull[k - 2], hull[k - 1], points[i]) <= 0) k--;
+      hull[k++] = points[i];
+    }
+    for (int i = points.size() - 2, t = k + 1; i >= 0; i--) {
+      while (k >= t && turn(hull[k - 2], hull[k - 1], points[i]) <= 0) k--;
+      hull[k++] = points[i];
+    }
+    hull.resize(k - 1);
+  }
+
+  double nm = r_to_d(1) * 60;  // radians to nautical miles
+  m_Hat.clear();
+  m_Area = 0;
+  for (size_t i = 0; i < hull.size(); i++) {
+    const std::pair<double, double>& a = hull[i];
+    const std::pair<double, double>& b = hull[(i + 1) % hull.size()];
+    m_Area += a.first * b.second - b.first * a.second;
+
+    double X[3];
+    for (int j = 0; j < 3; j++) X[j] = P[j] + a.first * E[j] + a.second * N[j];
+    double l = sqrt(dot3(X, X));
+    m_Hat.push_back(wxRealPoint(r_to_d(asin(X[2] / l)),
+                                r_to_d(atan2(X[1], X[0]))));
+  }
+  m_Area = fabs(m_Area) / 2 * nm * nm;
+
+  /* the largest circle inside touches three sides, so try the circle
+     touching each three and keep the largest that fits inside the rest */
+  m_InscribedLat = m_InscribedLon = m_InscribedRadius = NAN;
+  int h = hull.size();
+  if (h < 3) return;
+  std::vector<double> nx(h), ny(h), nd(h);  // inward normal of each side
+  for (int i = 0; i < h; i++) {
+    const std::pair<double, double>& a = hull[i];
+    const std::pair<double, double>& b = hull[(i + 1) % h];
+    double dx = b.first - a.first, dy = b.second - a.second;
+    double l = sqrt(dx * dx + dy * dy);
+    nx[i] = -dy / l, ny[i] = dx / l;
+    nd[i] = nx[i] * a.first + ny[i] * a.second;
+  }
+
+  double best = 0, bx = 0, by = 0;
+  for (int i = 0; i < h; i++)
+    for (int j = i + 1; j < h; j++)
+      for (int k = j + 1; k < h; k++) {
+        /* n.(x, y) - r = nd for each of the three sides, by Cramer's rule */
+        int s[3] = {i, j, k};
+        double M[3][3], R[3];
+        for (int e = 0; e < 3; e++) {
+          M[e][0] = nx[s[e]], M[e][1] = ny[s[e]], M[e][2] = -1;
+          R[e] = nd[s[e]];
+        }
+        double det = det3(M);
+        if (fabs(det) < 1e-12) continue;  // two sides parallel
+        double xyr[3];
+        for (int c = 0; c < 3; c++) {
+          double Mc[3][3];
+          for (int e = 0; e < 3; e++)
+            for (int f = 0; f < 3; f++) Mc[e][f] = f == c ? R[e] : M[e][f];
+          xyr[c] = det3(Mc) / det;
+        }
+        double x = xyr[0], y = xyr[1], r = xyr[2];
+        if (!(r > best)) continue;
+        bool inside = true;
+        for (int e = 0; e < h && inside; e++)
+          inside = nx[e] * x + ny[e] * y - nd[e] >= r * (1 - 1e-9);
+        if (inside) best = r, bx = x, by = y;
+      }
+  if (!(best > 0)) return;
+
+  double X[3];
+  for (int j = 0; j < 3; j++) X[j] = P[j] + bx * E[j] + by * N[j];
+  double l = sqrt(dot3(X, X));
+  m_InscribedLat = r_to_d(asin(X[2] / l));
+  m_InscribedLon = r_to_d(atan2(X[1], X[0]));
+  m_InscribedRadius = best * nm;
+}
+
+bool CockedHat::Inscribed(double& lat, double& lon, double& radius) const {
+  if (std::isnan(m_InscribedRadius)) return false;
+  lat = m_InscribedLat, lon = m_InscribedLon, radius = m_InscribedRadius;
+  return true;
+}
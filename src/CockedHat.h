@@ -0,0 +1,87 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#ifndef _COCKEDHAT_H_
+#define _COCKEDHAT_H_
+
+#include <vector>
+
+#include <wx/gdicmn.h>
+
+#include "FixEngine.h"
+
+/* The cocked hat of the lines of position about a fix.  Every pair of
+   circles of equal altitude is crossed in closed form from the geographic
+   positions, and the hat is the cell the lines divide the chart into that
+   holds the fix: its corners are the crossings, nearer the fix, on the
+   fix's side of every other line, where the lines cut at a useful angle.
+   For three sights it is the familiar triangle.  The crossings of pairs
+   whose sights did not change are kept between updates, so changing one
+   sight only crosses it again with the others. */
+class CockedHat {
+public:
+  CockedHat();
+
+  /* the hat of the contributions about the fix at lat, lon */
+  void Update(const std::vector<FixContribution>& contributions, double lat,
+              double lon);
+  void Clear();
+
+  /* pairs of sights whose circles cross, and how many of them the last
+     update had to cross again */
+  int Crossings() const { return m_Crossings; }
+  int Computed() const { return m_Computed; }
+
+  /* corners of the hat in order around it, latitude (x) and longitude (y),
+     a single point when the lines meet there */
+  const std::vector<wxRealPoint>& Hat() const { return m_Hat; }
+
+  /* area in square nautical miles */
+  double Area() const { return m_Area; }
+
+  /* center and radius in nautical miles of the largest circle inside the
+     hat, for three sights the point as far from each line as the others.
+     False if the hat has no inside */
+  bool Inscribed(double& lat, double& lon, double& radius) const;
+
+private:
+  struct Crossing {
+    bool valid;      // the circles meet
+    double p[2][3];  // where, as unit vectors
+    double cut;      // cosine of the angle between the lines there
+  };
+  static Crossing Cross(const FixContribution& a, const FixContribution& b);
+
+  std::vector<FixContribution> m_Contributions;
+  std::vector<Crossing> m_Pairs;  // i < j by rows of i
+  int m_Crossings, m_Computed;
+
+  std::vector<wxRealPoint> m_Hat;
+  double m_Area;
+  double m_InscribedLat, m_InscribedLon, m_InscribedRadius;
+};
+
+#endif  // _COCKEDHAT_H_
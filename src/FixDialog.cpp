@@ -42,16 +42,28 @@
 // #include <cmath>
 using namespace std;
 
+/* monte carlo samples of the fix */
+static const int s_SimulationSamples = 2000;
+
 FixDialog::FixDialog(CelestialNavigationDialog* parent)
     : FixDialogBase(parent),
       m_fixlat(NAN),
       m_fixlon(NAN),
       m_fixerror(NAN),
+      m_fixmajor(NAN),
+      m_fixminor(NAN),
+      m_fixbearing(NAN),
+      m_fixclock(NAN),
       m_Parent(parent) {
-  double lat, lon;
-  celestial_navigation_pi_BoatPos(lat, lon);
-  m_sInitialLatitude->SetValue(lat);
-  m_sInitialLongitude->SetValue(lon);
+  celestial_navigation_pi_BoatPos(m_drlat, m_drlon);
+  if (std::isnan(m_drlat) || std::isnan(m_drlon)) {
+    /* without a fix there is nothing to hold the clock to but the sights */
+    m_drlat = m_drlon = NAN;
+    m_sClockCertainty->SetValue(0);
+  } else {
+    m_sInitialLatitude->SetValue(m_drlat);
+    m_sInitialLongitude->SetValue(m_drlon);
+  }
   int x, y;
   GetTextExtent(_T("000° 00.0000' S"), &x, &y);
   m_stLatitude->SetSizeHints(x + 20, -1);
@@ -88,273 +100,165 @@ void FixDialog::OnEvtPanGesture(wxQT_PanGestureEvent& event) {
 }
 #endif
 
-double dist(wxRealPoint a, wxRealPoint b) {
-  double x = a.x - b.x;
-  double y = a.y - b.y;
-  if (y > 180) y -= 360;
-  if (y < -180) y += 360;
-
-  return x * x + y * y;
-}
-
-/* find smallest circle that fits set of points */
-double MinCircle(double& x, double& y, std::vector<wxRealPoint> points) {
-  if (points.size() < 2) return NAN;
-
-  double maxdist = 0;
-  /* find farthest points */
-  wxRealPoint maxa, maxb;
-  for (unsigned int i = 1; i < points.size(); i++) {
-    for (unsigned int j = 0; j < i; j++) {
-      wxRealPoint a = points[i], b = points[j];
-      double d = dist(a, b);
-      if (d > maxdist) maxa = a, maxb = b, maxdist = d;
-    }
+void FixDialog::Update(int clock_offset) {
+  m_clock_offset = clock_offset;
+  CelestialNavigationDialog* parent = (CelestialNavigationDialog*)GetParent();
+
+  /* shifted sights are moved about the last fix, or where the search starts
+     without one, and then about each new fix until it settles */
+  double reflat = m_fixlat, reflon = m_fixlon;
+  if (std::isnan(m_fixerror)) {
+    reflat = m_sInitialLatitude->GetValue();
+    reflon = m_sInitialLongitude->GetValue();
   }
 
-  /* now we should expand to include any points not bounded */
-
-  x = (maxa.x + maxb.x) / 2;
-  y = (maxa.y + maxb.y) / 2;
-  return maxdist / 4;
-}
+  double startlat = m_sInitialLatitude->GetValue();
+  double startlon = m_sInitialLongitude->GetValue();
+  double lat, lon, error, C[2][2], clock, CC[3][3];
+  bool solved, covariance;
+  for (int attempt = 0; attempt < 2; attempt++) {
+    for (int pass = 0; pass < 4; pass++) {
+      bool shifted =
+          m_FixEngine.Update(parent->m_Sights, clock_offset, reflat, reflon);
+
+      lat = startlat;
+      lon = startlon;
+      clock = 0;
+      if (m_cbSolveClock->GetValue()) {
+        /* the clock moves every line alike, so the dead reckoning, and any
+           moon sights, are what find it.  A certainty of 0 leaves it out */
+        double drsd = std::isnan(m_drlat) ? 0 : m_sClockCertainty->GetValue();
+        solved = m_FixEngine.SolveClock(lat, lon, error, clock, CC, m_drlat,
+                                        m_drlon, drsd);
+        for (int i = 0; i < 2; i++)
+          for (int j = 0; j < 2; j++) C[i][j] = CC[i][j];
+        covariance = solved;
+      } else {
+        solved = m_FixEngine.Solve(m_cbFixAlgorithm->GetSelection(), lat, lon,
+                                   error);
+        covariance = solved && m_FixEngine.Covariance(lat, lon, C);
+      }
 
-double MinCirclePoints(double& mincx, double& mincy,
-                       std::list<std::list<wxRealPoint> >& all_points,
-                       std::vector<wxRealPoint>& points) {
-  if (all_points.size() == 0) return MinCircle(mincx, mincy, points);
-
-  std::list<wxRealPoint> cpoints = all_points.front();
-  all_points.pop_front();
-
-  int s = points.size();
-  points.push_back(wxRealPoint());
-  double mind = INFINITY;
-  for (std::list<wxRealPoint>::iterator it = cpoints.begin();
-       it != cpoints.end(); it++) {
-    points[s] = *it;
-
-    double cx, cy, cd;
-    cd = MinCirclePoints(cx, cy, all_points, points);
-    if (cd < mind) {
-      mind = cd;
-      mincx = cx;
-      mincy = cy;
+      if (!solved || !shifted ||
+          (fabs(lat - reflat) < .005 &&
+           fabs(resolve_heading(lon - reflon)) * cos(d_to_r(lat)) < .005))
+        break;
+      reflat = lat, reflon = lon;
     }
-  }
-  points.pop_back();
-  all_points.push_front(cpoints);
-
-  if (isinf(mind)) return NAN;
-  return mind;
-}
-
-/* this algorithm works for any size, but c++ is sadly not supporting
-   pointers to variable size arrays like gcc does for c */
-int matrix_invert3(double a[3][3]) {
-  int n = 3;
 
-  int i, j, k;
-  // main cycle for columns of A matrix
-  for (k = 0; k < n; k++) {
-    // make current element 1
-    double aa = a[k][k];
-    if (aa == 0.0f) return 0;
-
-    double aainv = 1.0f / aa;
-
-    a[k][k] = 1.0f;
-    for (i = 0; i < n; i++) a[k][i] *= aainv;
-
-    // make all rows zero
-    for (j = 0; j < n; j++) {
-      if (j == k) continue;
-
-      aa = a[j][k];
-      a[j][k] = 0.0f;
-
-      for (i = 0; i < n; i++) a[j][i] -= a[k][i] * aa;
-    }
+    /* when the dead reckoning is too far off to converge from, start again
+       from the best place the sights fit anywhere */
+    if (solved || attempt) break;
+    m_FixEngine.Search(m_cbFixAlgorithm->GetSelection(), m_Candidates);
+    if (m_Candidates.empty()) break;
+    startlat = reflat = m_Candidates[0].lat;
+    startlon = reflon = m_Candidates[0].lon;
   }
-  return 1;
-}
-
-void FixDialog::Update(int clock_offset) {
-  std::list<std::vector<double> > J;
-  std::list<double> R;
 
-  double X[3]; /* result */
-
-  double initiallat = m_sInitialLatitude->GetValue(),
-         initiallon = m_sInitialLongitude->GetValue();
-  X[0] = cos(d_to_r(initiallat)) * cos(d_to_r(initiallon));
-  X[1] = cos(d_to_r(initiallat)) * sin(d_to_r(initiallon));
-  X[2] = sin(d_to_r(initiallat));
-
-  m_clock_offset = clock_offset;
-  int iterations = 0;
-again:
-  for (Sight& s : ((CelestialNavigationDialog*)GetParent())->m_Sights) {
-    if (!s.IsVisible() || s.m_Type != Sight::ALTITUDE) continue;
-
-    if (s.m_ShiftNm) {
-      static bool seenwarning = false;
-      if (!seenwarning) {
-        wxMessageDialog mdlg(
-            this, _("Shifted sights are not used to compute a fix, \
-determine fix visually instead.\n"),
-            wxString(_("Fix Position"), wxID_OK | wxICON_WARNING));
-        mdlg.ShowModal();
-        seenwarning = true;
-      }
-      continue;
-    }
+  if (solved && m_cbSolveClock->GetValue()) {
+    m_fixclock = clock;
+    m_stClockCorrection->SetValue(
+        wxString::Format(_T("%+.1f s ± %.1f s"), clock, sqrt(CC[2][2])));
+    m_bApplyClock->Enable(fabs(clock) >= .5);
+  } else {
+    m_fixclock = NAN;
+    m_stClockCorrection->SetValue(m_cbSolveClock->GetValue() ? _("   N/A   ")
+                                                             : _T(""));
+    m_bApplyClock->Disable();
+  }
 
-    double lat, lon;
-    s.BodyLocation(s.m_DateTime + wxTimeSpan::Seconds(clock_offset), &lat, &lon,
-                   0, 0, 0);
-
-    /* take vector from body location of length equal to
-       normalized measurement (so the plane this vector
-       describes intersects the unit sphere along the positions
-       the sight is valid) */
-    std::vector<double> v;
-    double x = cos(d_to_r(lat)) * cos(d_to_r(lon));
-    double y = cos(d_to_r(lat)) * sin(d_to_r(lon));
-    double z = sin(d_to_r(lat));
-
-    double sm = sin(d_to_r(s.m_ObservedAltitude));
-    double cm = cos(d_to_r(s.m_ObservedAltitude));
-
-    double d = NAN;
-
-    switch (m_cbFixAlgorithm->GetSelection()) {
-      case 0: /* plane */
-      plane:
-        /* plane */
-        v.push_back(x);
-        v.push_back(y);
-        v.push_back(z);
-        d = sm - (X[0] * x + X[1] * y + X[2] * z);
-        break;
-      case 1: /* sphere */
-      {
-        double xc = X[0] - x, yc = X[1] - y, zc = X[2] - z;
-        v.push_back(2 * xc);
-        v.push_back(2 * yc);
-        v.push_back(2 * zc);
-        d = cm * cm + (1 - sm) * (1 - sm) - xc * xc - yc * yc - zc * zc;
-      } break;
-      case 2: /* cone */
-      {
-        double t2 = X[0] * X[0] + X[1] * X[1] + X[2] * X[2], t = sqrt(t2);
-        if (t < .1) goto plane;
-        v.push_back(x);
-        v.push_back(y);
-        v.push_back(z);
-        d = sm - (X[0] * x + X[1] * y + X[2] * z) / t;
-      } break;
-      case 3: /* cone 2 */
-      {
-        double t2 = X[0] * X[0] + X[1] * X[1] + X[2] * X[2], t = sqrt(t2);
-        if (t < .1) goto plane;
-        v.push_back(x / t - x * X[0] * X[0] / (t * t2));
-        v.push_back(y / t - y * X[1] * X[1] / (t * t2));
-        v.push_back(z / t - z * X[2] * X[2] / (t * t2));
-        d = sm - (X[0] * x + X[1] * y + X[2] * z) / t;
-      } break;
-    }
+  if (solved) {
+    m_fixlat = lat;
+    m_fixlon = lon;
+    m_fixerror = error;
 
-    J.push_back(v);
-    R.push_back(d);
-  }
+    wxString errorstr = wxString::Format(_T("%.3g"), m_fixerror);
+    if (covariance) {
+      FixEngine::Ellipse(C, .95, m_fixmajor, m_fixminor, m_fixbearing);
+      errorstr += wxString::Format(_T("  %.1f x %.1f nm %03.0f°"),
+                                   2 * m_fixmajor, 2 * m_fixminor,
+                                   m_fixbearing);
+    } else
+      m_fixmajor = m_fixminor = m_fixbearing = NAN;
 
-  /* it takes at least 2 visible sights to have a fix */
-  if (J.size() < 2) {
+    m_stLatitude->SetValue(toSDMM_PlugIn(1, m_fixlat, true));
+    m_stLongitude->SetValue(toSDMM_PlugIn(2, m_fixlon, true));
+    m_stFixError->SetValue(errorstr);
+    m_bGo->Enable();
+  } else {
     m_fixerror = NAN;
+    m_fixmajor = m_fixminor = m_fixbearing = NAN;
     m_stLatitude->SetValue(_("   N/A   "));
     m_stLongitude->SetValue(_("   N/A   "));
     m_stFixError->SetValue(_("   N/A   "));
     m_bGo->Disable();
-    return;
   }
 
-  /* fit to unit sphere (keep results on surface of earth) */
-  {
-    std::vector<double> v;
-    v.push_back(2 * X[0]);
-    v.push_back(2 * X[1]);
-    v.push_back(2 * X[2]);
-    J.push_back(v);
-    double d = 1 - X[0] * X[0] - X[1] * X[1] - X[2] * X[2];
-    R.push_back(d);
+  /* everywhere else the sights fit, as two bodies do where their circles
+     cross twice, with the one that is the fix selected */
+  m_FixEngine.Search(m_cbFixAlgorithm->GetSelection(), m_Candidates);
+  m_cCandidates->Clear();
+  for (FixEngine::Candidate& c : m_Candidates) {
+    m_cCandidates->Append(toSDMM_PlugIn(1, c.lat, true) + _T("  ") +
+                          toSDMM_PlugIn(2, c.lon, true) +
+                          wxString::Format(_T("  %.3g"), c.error));
+    if (IsFix(c)) m_cCandidates->SetSelection(m_cCandidates->GetCount() - 1);
   }
 
-  /* now use least squares to find the point where all these planes
-     intersect, it is our fix */
-
-  /* least squares all the great_circles to find fix
-     JtJ^-1 * JtRt */
-
-  double S[3][3]; /* S = Jt*J */
-  std::list<std::vector<double> >::iterator it;
-  std::list<double>::iterator it2;
-  for (int i = 0; i < 3; i++)
-    for (int j = 0; j < 3; j++) {
-      S[i][j] = 0;
-      for (it = J.begin(); it != J.end(); it++) S[i][j] += (*it)[i] * (*it)[j];
-    }
-
-  double N[3]; /* N = (JtRt)t  R is all 1's since this is linear */
-  for (int i = 0; i < 3; i++) {
-    N[i] = 0;
-    for (it = J.begin(), it2 = R.begin(); it != J.end(); it++, it2++)
-      N[i] += (*it)[i] * (*it2);
+  /* the hat the lines leave about the fix, only the sights that changed
+     are crossed again */
+  m_stCockedHat->SetValue(_T(""));
+  if (!m_cbCockedHat->GetValue() || !solved)
+    m_CockedHat.Clear();
+  else {
+    std::vector<FixContribution> lines;
+    m_FixEngine.Contributions(lines);
+    m_CockedHat.Update(lines, lat, lon);
+    double ilat, ilon, radius;
+    if (m_CockedHat.Inscribed(ilat, ilon, radius))
+      m_stCockedHat->SetValue(wxString::Format(
+          _T("%.2f nm²  r %.2f nm  %d/%d"), m_CockedHat.Area(), radius,
+          (int)m_CockedHat.Hat().size(), m_CockedHat.Crossings()));
+    else
+      m_stCockedHat->SetValue(_("   N/A   "));
   }
 
-  /* invert S */
-  double d, err;
-  if (!matrix_invert3(S)) goto fail;
-
-  for (int i = 0; i < 3; i++)
-    for (int j = 0; j < 3; j++) X[i] += S[i][j] * N[j];
-
-  d = sqrt(X[0] * X[0] + X[1] * X[1] + X[2] * X[2]);
-  err = fabs(d - 1);
+  /* how far off the fix could be from the certainties of its sights */
+  m_FixSimulation.Clear();
+  m_stMonteCarlo->SetValue(_T(""));
+  if (m_cbMonteCarlo->GetValue()) {
+    std::vector<FixSimulation::Input> inputs;
+    for (Sight& s : parent->m_Sights) {
+      FixContribution c;
+      if (s.IsVisible() && s.m_Type == Sight::ALTITUDE &&
+          m_FixEngine.Find(s, clock_offset, c))
+        inputs.push_back(FixSimulation::MakeInput(s, c));
+    }
 
-  /* 20 is overkill to converge. there are better ways to determine the number
-     of iterations, but this routine runs so fast it doesn't matter */
-  if (iterations++ < 20) {
-    if (err > 100) /* we are diverging */
-      goto fail;
-    J.clear();
-    R.clear();
-    goto again;
+    double slat, slon, SC[2][2], major, minor, bearing;
+    int count = 0;
+    if (solved)
+      count = m_FixSimulation.Run(inputs, m_cbFixAlgorithm->GetSelection(),
+                                  lat, lon, s_SimulationSamples);
+    if (count && m_FixSimulation.Spread(slat, slon, SC)) {
+      FixEngine::Ellipse(SC, .95, major, minor, bearing);
+      m_stMonteCarlo->SetValue(
+          wxString::Format(_T("%.1f x %.1f nm %03.0f°  %d/%d"), 2 * major,
+                           2 * minor, bearing, count, s_SimulationSamples));
+    } else
+      m_stMonteCarlo->SetValue(_("   N/A   "));
   }
 
-  /* normalize */
-  X[0] /= d, X[1] /= d, X[2] /= d;
+  /* show the sights a robust fix rejected */
+  std::vector<bool> outliers;
+  for (Sight& s : parent->m_Sights)
+    outliers.push_back(m_FixEngine.IsOutlier(s, clock_offset));
+  parent->MarkOutliers(outliers);
 
-  m_fixlat = r_to_d(asin(X[2]));
-  m_fixlon = r_to_d(atan2(X[1], X[0]));
-
-  if (err <= .1) {
-    m_fixerror = 0;
-    for (it2 = R.begin(); it2 != R.end(); it2++) m_fixerror += (*it2) * (*it2);
-    m_fixerror = sqrt(m_fixerror);
-
-    m_stLatitude->SetValue(toSDMM_PlugIn(1, m_fixlat, true));
-    m_stLongitude->SetValue(toSDMM_PlugIn(2, m_fixlon, true));
-    m_stFixError->SetValue(wxString::Format(_T("%.3g"), m_fixerror));
-    m_bGo->Enable();
-  } else {
-  fail:
-    m_fixerror = NAN;
-    m_stLatitude->SetValue(_("   N/A   "));
-    m_stLongitude->SetValue(_("   N/A   "));
-    m_stFixError->SetValue(_("   N/A   "));
-    m_bGo->Disable();
-  }
+  if (m_cbResiduals->GetValue())
+    m_FixEngine.Contributions(m_MapContributions);
+  else
+    m_MapContributions.clear();
 
   RequestRefresh(GetParent()->GetParent());
 }
@@ -368,4 +272,37 @@ void FixDialog::OnGo(wxCommandEvent& event) {
   JumpToPosition(m_fixlat, m_fixlon, scale);
 }
 
+bool FixDialog::IsFix(const FixEngine::Candidate& c) const {
+  return !std::isnan(m_fixerror) && fabs(c.lat - m_fixlat) < .02 &&
+         fabs(resolve_heading(c.lon - m_fixlon)) * cos(d_to_r(c.lat)) < .02;
+}
+
+/* a DR entered by hand replaces the boat's position for the clock */
+void FixDialog::OnUpdateSpin(wxSpinEvent& event) {
+  if (event.GetEventObject() == m_sInitialLatitude ||
+      event.GetEventObject() == m_sInitialLongitude) {
+    m_drlat = m_sInitialLatitude->GetValue();
+    m_drlon = m_sInitialLongitude->GetValue();
+  }
+  Update(m_clock_offset);
+}
+
+/* start the fix from the chosen candidate, the nearest whole degree is
+   well inside where it converges to it */
+void FixDialog::OnCandidate(wxCommandEvent& event) {
+  int i = m_cCandidates->GetSelection();
+  if (i < 0 || i >= (int)m_Candidates.size()) return;
+  m_sInitialLatitude->SetValue((int)round(m_Candidates[i].lat));
+  m_sInitialLongitude->SetValue((int)round(m_Candidates[i].lon));
+  m_fixerror = NAN;  // shifted sights move about the candidate
+  Update(m_clock_offset);
+}
+
+/* fold the estimated clock error into the clock correction, which
+   recomputes the sights and so this fix */
+void FixDialog::OnApplyClock(wxCommandEvent& event) {
+  if (std::isnan(m_fixclock)) return;
+  m_Parent->SetClockCorrection(m_clock_offset + (int)round(m_fixclock));
+}
+
 void FixDialog::OnClose(wxCommandEvent& event) { m_Parent->OnFixClose(); }
@@ -30,6 +30,9 @@
 
 #include "CelestialNavigationUI.h"
 #include "CelestialNavigationDialog.h"
+#include "CockedHat.h"
+#include "FixEngine.h"
+#include "FixSimulation.h"
 
 #include <list>
 
@@ -43,20 +46,41 @@ class FixDialog : public FixDialogBase {
 public:
   FixDialog(CelestialNavigationDialog* parent);
   void Update(int clock_offset);
+  /* whether a candidate is the fix shown */
+  bool IsFix(const FixEngine::Candidate& c) const;
 
   int m_clock_offset;
   double m_fixlat, m_fixlon, m_fixerror;
+  /* 95% error ellipse, semi-axes in nautical miles and true bearing of the
+     major axis, NaN if unknown */
+  double m_fixmajor, m_fixminor, m_fixbearing;
+  /* seconds to add to the clock correction if it was solved for, else NaN */
+  double m_fixclock;
+  /* sights for the residual map, empty when it is off */
+  std::vector<FixContribution> m_MapContributions;
+  /* monte carlo samples of the fix, empty when they are off */
+  FixSimulation m_FixSimulation;
+  /* everywhere the sights fit, best first */
+  std::vector<FixEngine::Candidate> m_Candidates;
+  /* the lines' cocked hat about the fix, empty when it is off */
+  CockedHat m_CockedHat;
 
 private:
   void OnGo(wxCommandEvent& event);
+  void OnApplyClock(wxCommandEvent& event);
+  void OnCandidate(wxCommandEvent& event);
   void OnClose(wxCommandEvent& event);
   void OnUpdate(wxCommandEvent& event) { Update(m_clock_offset); }
-  void OnUpdateSpin(wxSpinEvent& event) { Update(m_clock_offset); }
+  void OnUpdateSpin(wxSpinEvent& event);
 #ifdef __OCPN__ANDROID__
   void OnEvtPanGesture(wxQT_PanGestureEvent& event);
 #endif
 
   CelestialNavigationDialog* m_Parent;
+  FixEngine m_FixEngine;
+  /* dead reckoning the clock is solved against, the boat's position when
+     the dialog opened until the DR spinners are changed, NaN if neither */
+  double m_drlat, m_drlon;
   int m_lastPanX;
   int m_lastPanY;
 };
@@ -0,0 +1,862 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <random>
+
+#include "FixEngine.h"
+#include "Sight.h"
+#include "celestial_navigation_pi.h"
+
+static double dot3(const double a[3], const double b[3]) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void cross3(const double a[3], const double b[3], double c[3]) {
+  c[0] = a[1] * b[2] - a[2] * b[1];
+  c[1] = a[2] * b[0] - a[0] * b[2];
+  c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+/* whether every term of c is a number, a sight without a measurement
+   leaves NaN that would spread through the sums */
+static bool Finite(const FixContribution& c) {
+  return std::isfinite(c.x) && std::isfinite(c.y) && std::isfinite(c.z) &&
+         std::isfinite(c.sm) && std::isfinite(c.w) && std::isfinite(c.rate) &&
+         std::isfinite(c.decrate);
+}
+
+FixEngine::FixEngine() { Clear(); }
+
+size_t FixEngine::KeyHash::operator()(const Key& k) const {
+  size_t h = std::hash<std::wstring>()(k.body);
+  h = h * 31 + std::hash<long long>()(k.ticks);
+  h = h * 31 + std::hash<double>()(k.altitude);
+  h = h * 31 + std::hash<double>()(k.certainty);
+  h = h * 31 + std::hash<double>()(k.timecertainty);
+  h = h * 31 + std::hash<double>()(k.shiftnm);
+  return h * 31 + std::hash<double>()(k.shiftbearing) + k.magnetic;
+}
+
+FixEngine::Key FixEngine::MakeKey(Sight& s, int clock_offset) {
+  wxDateTime time = s.m_DateTime + wxTimeSpan::Seconds(clock_offset);
+  Key key = {s.m_Body.ToStdWstring(), time.GetValue().GetValue(),
+             s.m_ObservedAltitude, s.m_MeasurementCertainty,
+             s.m_TimeCertainty, s.m_ShiftNm, s.m_ShiftBearing,
+             s.m_ShiftNm && s.m_bMagneticShiftBearing};
+  return key;
+}
+
+FixContribution FixEngine::Contribution(double gplat, double gplon,
+                                        double altitude, double certainty,
+                                        double timecertainty, double rate,
+                                        double decrate) {
+  FixContribution c;
+  c.x = cos(d_to_r(gplat)) * cos(d_to_r(gplon));
+  c.y = cos(d_to_r(gplat)) * sin(d_to_r(gplon));
+  c.z = sin(d_to_r(gplat));
+  c.sm = sin(d_to_r(altitude));
+
+  /* the certainties are taken as standard deviations.  A time error moves
+     the geographic position, changing the altitude by at most the speed it
+     moves at, which is used so the weight does not depend on the fix */
+  double sa = d_to_r(certainty / 60);
+  double st = d_to_r(timecertainty / 3600) *
+              hypot(rate * cos(d_to_r(gplat)), decrate);
+  double variance = wxMax(sa * sa + st * st, 1e-12);  // a few meters
+
+  /* the row is in the sine of the altitude, which changes by cos(altitude)
+     per radian */
+  double ca = wxMax(cos(d_to_r(altitude)), .01);
+  c.w = 1 / (variance * ca * ca);
+  c.rate = d_to_r(rate / 3600);
+  c.decrate = d_to_r(decrate / 3600);
+  return c;
+}
+
+void FixEngine::Rates(Sight& s, const wxDateTime& time, double& rate,
+                      double& decrate) {
+  double lat1, lon1, lat2, lon2;
+  s.BodyLocation(time - wxTimeSpan::Minute(), &lat1, &lon1, 0, 0, 0);
+  s.BodyLocation(time + wxTimeSpan::Minute(), &lat2, &lon2, 0, 0, 0);
+
+  /* the hour angle grows as the longitude of the position falls */
+  rate = -resolve_heading(lon2 - lon1) * 30;
+  decrate = (lat2 - lat1) * 30;
+}
+
+FixContribution FixEngine::Later(const FixContribution& c, double seconds) {
+  double lat = asin(wxMax(-1.0, wxMin(1.0, c.z))) + c.decrate * seconds;
+  double lon = atan2(c.y, c.x) - c.rate * seconds;
+  FixContribution later = c;
+  later.x = cos(lat) * cos(lon);
+  later.y = cos(lat) * sin(lon);
+  later.z = sin(lat);
+  return later;
+}
+
+/* unit vector toward a true bearing at the unit vector P */
+static void Direction(const double P[3], double bearing, double t[3]) {
+  double lon = atan2(P[1], P[0]);
+  double east[3] = {-sin(lon), cos(lon), 0}, north[3];
+  cross3(P, east, north);
+  double sb = sin(d_to_r(bearing)), cb = cos(d_to_r(bearing));
+  for (int i = 0; i < 3; i++) t[i] = cb * north[i] + sb * east[i];
+}
+
+FixContribution FixEngine::Shift(const FixContribution& c, double lat,
+                                 double lon, double nm, double bearing) {
+  double g[3] = {c.x, c.y, c.z}, t[3];
+  double d = d_to_r(nm / 60), cd = cos(d), sd = sin(d);
+
+  /* where the boat was at the sight if it is at lat, lon now */
+  double R[3] = {cos(d_to_r(lat)) * cos(d_to_r(lon)),
+                 cos(d_to_r(lat)) * sin(d_to_r(lon)), sin(d_to_r(lat))};
+  Direction(R, bearing, t);
+  for (int i = 0; i < 3; i++) R[i] = R[i] * cd - t[i] * sd;
+
+  /* the point P of the circle nearest there, toward it from g by the
+     zenith distance */
+  double RG = dot3(R, g), u[3];
+  for (int i = 0; i < 3; i++) u[i] = R[i] - RG * g[i];
+  double l = sqrt(dot3(u, u));
+  if (l < 1e-9) {  // it is at g, any direction will do
+    double z[3] = {0, 0, 1}, x[3] = {1, 0, 0};
+    cross3(g, fabs(g[2]) < .9 ? z : x, u);
+    l = sqrt(dot3(u, u));
+  }
+  double sz = sqrt(wxMax(1 - c.sm * c.sm, 0.0)), P[3];
+  for (int i = 0; i < 3; i++) P[i] = c.sm * g[i] + sz * u[i] / l;
+
+  /* turn g about the axis a which moves P along the bearing, by
+     rodrigues' formula */
+  double a[3], ag[3];
+  Direction(P, bearing, t);
+  cross3(P, t, a);
+  double la = sqrt(dot3(a, a));
+  a[0] /= la, a[1] /= la, a[2] /= la;
+  cross3(a, g, ag);
+  double k = dot3(a, g) * (1 - cd);
+
+  FixContribution shifted = c;
+  shifted.x = g[0] * cd + ag[0] * sd + a[0] * k;
+  shifted.y = g[1] * cd + ag[1] * sd + a[1] * k;
+  shifted.z = g[2] * cd + ag[2] * sd + a[2] * k;
+  return shifted;
+}
+
+bool FixEngine::Update(std::vector<Sight>& sights, int clock_offset,
+                       double lat, double lon) {
+  bool shifted = false;
+  for (auto& e : m_Entries) e.second.used = 0;
+
+  double about[3] = {cos(d_to_r(lat)) * cos(d_to_r(lon)),
+                     cos(d_to_r(lat)) * sin(d_to_r(lon)), sin(d_to_r(lat))};
+
+  for (Sight& s : sights) {
+    if (!s.IsVisible() || s.m_Type != Sight::ALTITUDE) continue;
+
+    /* a NaN altitude makes a key that never matches itself */
+    if (!std::isfinite(s.m_ObservedAltitude)) continue;
+
+    Key key = MakeKey(s, clock_offset);
+    auto it = m_Entries.find(key);
+    if (it == m_Entries.end()) {
+      wxDateTime time = s.m_DateTime + wxTimeSpan::Seconds(clock_offset);
+      double gplat, gplon, rate, decrate;
+      s.BodyLocation(time, &gplat, &gplon, 0, 0, 0);
+      Rates(s, time, rate, decrate);
+
+      Entry e;
+      e.c = e.gp = Contribution(gplat, gplon, s.m_ObservedAltitude,
+                                s.m_MeasurementCertainty, s.m_TimeCertainty,
+                                rate, decrate);
+      if (!Finite(e.c)) continue;
+      e.about[0] = e.about[1] = e.about[2] = 0;
+      e.count = e.used = 0;
+      e.outlier = false;
+      it = m_Entries.insert(std::make_pair(key, e)).first;
+    }
+    Entry& e = it->second;
+    e.used++;
+
+    /* shifted sights are moved again once the point they were moved about
+       is more than a third of a mile from the fix */
+    if (!s.m_ShiftNm) continue;
+    shifted = true;
+    double dx = e.about[0] - about[0], dy = e.about[1] - about[1],
+           dz = e.about[2] - about[2];
+    if (dx * dx + dy * dy + dz * dz < 1e-8) continue;
+
+    double bearing = s.m_ShiftBearing;
+    if (s.m_bMagneticShiftBearing) {
+      double variation = s.MagneticVariation(lat, lon);
+      if (!std::isnan(variation)) bearing += variation;
+    }
+    for (int i = 0; i < e.count; i++, m_Removed++) Remove(e.c);
+    e.c = Shift(e.gp, lat, lon, s.m_ShiftNm, bearing);
+    for (int i = 0; i < e.count; i++) Add(e.c);
+    memcpy(e.about, about, sizeof about);
+  }
+
+  /* apply the difference, dropping sights no longer present */
+  for (auto it = m_Entries.begin(); it != m_Entries.end();) {
+    Entry& e = it->second;
+    for (; e.count < e.used; e.count++) Add(e.c);
+    for (; e.count > e.used; e.count--, m_Removed++) Remove(e.c);
+    if (e.count)
+      it++;
+    else
+      it = m_Entries.erase(it);
+  }
+
+  /* subtracting leaves rounding behind, start over once it has been done
+     more often than there are sights */
+  if (m_Removed > (int)m_Entries.size()) Resum();
+  return shifted;
+}
+
+bool FixEngine::Find(Sight& s, int clock_offset, FixContribution& c) {
+  auto it = m_Entries.find(MakeKey(s, clock_offset));
+  if (it == m_Entries.end() || !it->second.count) return false;
+  c = it->second.c;
+  return true;
+}
+
+void FixEngine::Contributions(std::vector<FixContribution>& c) const {
+  c.clear();
+  for (auto& it : m_Entries)
+    for (int i = 0; i < it.second.count; i++) c.push_back(it.second.c);
+}
+
+bool FixEngine::IsOutlier(Sight& s, int clock_offset) {
+  auto it = m_Entries.find(MakeKey(s, clock_offset));
+  return m_bRobust && it != m_Entries.end() && it->second.outlier;
+}
+
+void FixEngine::Clear() {
+  m_Entries.clear();
+  m_Removed = 0;
+  m_bRobust = false;
+  m_n = m_W = m_s = m_C = 0;
+  memset(m_G, 0, sizeof m_G);
+  memset(m_A, 0, sizeof m_A);
+  memset(m_B, 0, sizeof m_B);
+}
+
+void FixEngine::Resum() {
+  std::unordered_map<Key, Entry, KeyHash> entries;
+  entries.swap(m_Entries);
+  Clear();
+  for (auto& e : entries)
+    for (int i = 0; i < e.second.count; i++) Add(e.second.c);
+  m_Entries.swap(entries);
+}
+
+void FixEngine::Accumulate(const FixContribution& c, double sign) {
+  double g[3] = {c.x, c.y, c.z};
+  double w = sign * c.w;
+  m_n += sign;
+  m_W += w;
+  m_s += w * c.sm;
+  m_C += w * c.sm * c.sm;
+  for (int i = 0; i < 3; i++) {
+    m_G[i] += w * g[i];
+    m_B[i] += w * c.sm * g[i];
+    for (int j = 0; j < 3; j++) m_A[i][j] += w * g[i] * g[j];
+  }
+}
+
+/* solve S x = N for the symmetric n by n normal matrix S by LDLt
+   decomposition, which needs no square roots and fails cleanly if S is
+   singular */
+template <int n>
+static bool ldlt_solve(const double S[n][n], const double N[n], double x[n]) {
+  double L[n][n], D[n];
+  double scale = 0;
+  for (int j = 0; j < n; j++) scale += fabs(S[j][j]);
+  for (int j = 0; j < n; j++) {
+    D[j] = S[j][j];
+    for (int k = 0; k < j; k++) D[j] -= L[j][k] * L[j][k] * D[k];
+    if (!(D[j] > 1e-15 * scale)) return false;
+    for (int i = j + 1; i < n; i++) {
+      L[i][j] = S[i][j];
+      for (int k = 0; k < j; k++) L[i][j] -= L[i][k] * L[j][k] * D[k];
+      L[i][j] /= D[j];
+    }
+  }
+
+  /* forward substitution, then the diagonal, then back substitution */
+  double y[n];
+  for (int i = 0; i < n; i++) {
+    y[i] = N[i];
+    for (int k = 0; k < i; k++) y[i] -= L[i][k] * y[k];
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    x[i] = y[i] / D[i];
+    for (int k = i + 1; k < n; k++) x[i] -= L[k][i] * x[k];
+  }
+  return true;
+}
+
+bool FixEngine::Solve(int algorithm, double& lat, double& lon,
+                      double& error) {
+  m_bRobust = false;
+
+  /* it takes at least 2 visible sights to have a fix */
+  if (Count() < 2) return false;
+
+  if (algorithm == ROBUST) return SolveRobust(lat, lon, error);
+
+  double X[3];
+  X[0] = cos(d_to_r(lat)) * cos(d_to_r(lon));
+  X[1] = cos(d_to_r(lat)) * sin(d_to_r(lon));
+  X[2] = sin(d_to_r(lat));
+
+  double d = 1, err = NAN, R2 = 0;
+  double w = m_W / m_n;  // mean weight
+
+  /* gauss-newton, the step shrinks quickly once near the fix so this
+     usually stops after a handful of iterations */
+  const int max_iterations = 50;
+  for (int iterations = 0; iterations < max_iterations; iterations++) {
+    /* JtJ, JtR and the sum of squared residuals of every sight, written in
+       terms of the sums so no sight is visited */
+    double S[3][3], N[3];
+    double AX[3];
+    for (int i = 0; i < 3; i++) AX[i] = dot3(m_A[i], X);
+    double XAX = dot3(X, AX), t2 = dot3(X, X), t = sqrt(t2);
+
+    if (algorithm == SPHERE) {
+      /* each sight has v = 2 (X - g) and
+         residual q - 2 sm + 2 X.g with q = 1 - X.X */
+      double q = 1 - t2, XG = dot3(X, m_G);
+      double k = m_W * q - 2 * m_s + 2 * XG;
+      for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++)
+          S[i][j] = 4 * (m_W * X[i] * X[j] - X[i] * m_G[j] - m_G[i] * X[j] +
+                         m_A[i][j]);
+        N[i] = 2 * (X[i] * k - (m_G[i] * q - 2 * m_B[i] + 2 * AX[i]));
+      }
+      R2 = m_W * q * q + 4 * m_C + 4 * XAX - 4 * q * m_s + 4 * q * XG -
+           8 * dot3(X, m_B);
+    } else {
+      /* plane has v = g and residual sm - X.g, the cones divide X by its
+         length and cone 2 also scales each axis of v */
+      double r = (algorithm == PLANE || t < .1) ? 1 : 1 / t;
+      double D[3] = {1, 1, 1};
+      if (algorithm == CONE2 && t >= .1)
+        for (int i = 0; i < 3; i++) D[i] = 1 / t - X[i] * X[i] / (t * t2);
+      for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) S[i][j] = D[i] * D[j] * m_A[i][j];
+        N[i] = D[i] * (m_B[i] - r * AX[i]);
+      }
+      R2 = m_C - 2 * r * dot3(X, m_B) + r * r * XAX;
+    }
+
+    /* fit to unit sphere (keep results on surface of earth), weighted as
+       an average sight */
+    double e = 1 - t2;
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) S[i][j] += 4 * w * X[i] * X[j];
+      N[i] += 2 * w * X[i] * e;
+    }
+    R2 += w * e * e;
+
+    double dX[3];
+    if (!ldlt_solve<3>(S, N, dX)) return false;
+    X[0] += dX[0], X[1] += dX[1], X[2] += dX[2];
+
+    d = sqrt(dot3(X, X));
+    err = fabs(d - 1);
+    if (err > 100) /* we are diverging */
+      return false;
+
+    /* a step of 1e-10 earth radii is under a millimeter */
+    if (dot3(dX, dX) < 1e-20) break;
+  }
+
+  if (!(err <= .1)) return false;
+
+  /* normalize */
+  X[0] /= d, X[1] /= d, X[2] /= d;
+
+  lat = r_to_d(asin(X[2]));
+  lon = r_to_d(atan2(X[1], X[0]));
+  /* in terms of the residuals of an average sight, so equal weights give
+     the root of the sum of squares.  The sums cancel to rounding at a fit */
+  error = sqrt(wxMax(R2 / w, 0.0));
+  return true;
+}
+
+bool FixEngine::SolveClock(double& lat, double& lon, double& error,
+                           double& clock, double C[3][3], double dr_lat,
+                           double dr_lon, double dr_sd) {
+  m_bRobust = false;
+
+  /* position and clock take at least 3 sights, or 2 and a position */
+  bool dr = dr_sd > 0;
+  if (Count() < (dr ? 2 : 3)) return false;
+
+  double D[3], wd = 0;
+  if (dr) {
+    D[0] = cos(d_to_r(dr_lat)) * cos(d_to_r(dr_lon));
+    D[1] = cos(d_to_r(dr_lat)) * sin(d_to_r(dr_lon));
+    D[2] = sin(d_to_r(dr_lat));
+    wd = 1 / (d_to_r(dr_sd / 60) * d_to_r(dr_sd / 60));
+  }
+
+  double X[3];
+  X[0] = cos(d_to_r(lat)) * cos(d_to_r(lon));
+  X[1] = cos(d_to_r(lat)) * sin(d_to_r(lon));
+  X[2] = sin(d_to_r(lat));
+  double tau = clock, S[3][3], R2 = 0;
+
+  /* adding tau seconds to the sight times moves each geographic position
+     rate tau radians west and decrate tau north.  The bodies don't share
+     rates, so unlike the other fixes this visits the cached positions,
+     moving them along their hour angle exactly so the clock and longitude,
+     which the sights only just tell apart, are not mixed up by the error
+     of a linear model.  The unknowns are the east and north moves of X and
+     the clock */
+  bool converged = false;
+  const int max_iterations = 50;
+  for (int iterations = 0; iterations < max_iterations; iterations++) {
+    double slat = X[2], clat = hypot(X[0], X[1]);
+    double slon = clat > 0 ? X[1] / clat : 0,
+           clon = clat > 0 ? X[0] / clat : 1;
+    double T[2][3] = {{-slon, clon, 0}, {-slat * clon, -slat * slon, clat}};
+
+    double N[3] = {0, 0, 0};
+    memset(S, 0, sizeof S);
+    R2 = 0;
+    for (auto& it : m_Entries) {
+      const Entry& e = it.second;
+      if (!e.count) continue;
+      const FixContribution& c = e.c;
+      FixContribution l = Later(c, tau);
+      double h[3] = {l.x, l.y, l.z};
+
+      /* the row's derivatives: east, north, and the move of h, west about
+         the pole and north along its meridian */
+      double hc = wxMax(hypot(h[0], h[1]), 1e-12);
+      double hn[3] = {-h[2] * h[0] / hc, -h[2] * h[1] / hc, hc};
+      double J[3] = {dot3(T[0], h), dot3(T[1], h),
+                     c.rate * (X[0] * h[1] - X[1] * h[0]) +
+                         c.decrate * dot3(X, hn)};
+      double r = c.sm - dot3(X, h), w = e.count * c.w;
+      for (int i = 0; i < 3; i++) {
+        for (int j = i; j < 3; j++) S[i][j] += w * J[i] * J[j];
+        N[i] += w * J[i] * r;
+      }
+      R2 += w * r * r;
+    }
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < i; j++) S[i][j] = S[j][i];
+
+    /* the known position adds a row along east and one along north */
+    if (dr) {
+      double DX[3] = {D[0] - X[0], D[1] - X[1], D[2] - X[2]};
+      for (int i = 0; i < 2; i++) {
+        S[i][i] += wd;
+        N[i] += wd * dot3(T[i], DX);
+      }
+    }
+
+    double d[3];
+    if (!ldlt_solve<3>(S, N, d)) return false;
+    for (int i = 0; i < 3; i++) X[i] += d[0] * T[0][i] + d[1] * T[1][i];
+    double l = sqrt(dot3(X, X));
+    X[0] /= l, X[1] /= l, X[2] /= l;
+    tau += d[2];
+
+    /* a correction of an hour is no longer a clock error */
+    if (!(fabs(tau) < 3600)) return false;
+
+    /* under a millimeter and a microsecond */
+    if (d[0] * d[0] + d[1] * d[1] < 1e-20 && fabs(d[2]) < 1e-6) {
+      converged = true;
+      break;
+    }
+  }
+  if (!converged) return false;
+
+  lat = r_to_d(asin(X[2]));
+  lon = r_to_d(atan2(X[1], X[0]));
+  clock = tau;
+  error = sqrt(wxMax(R2 / (m_W / m_n), 0.0));
+
+  /* the inverse of the normal matrix, a column at a time */
+  double nm = r_to_d(1) * 60, scale[3] = {nm, nm, 1};
+  for (int j = 0; j < 3; j++) {
+    double e[3] = {0, 0, 0}, c[3];
+    e[j] = 1;
+    if (!ldlt_solve<3>(S, e, c)) return false;
+    for (int i = 0; i < 3; i++) C[i][j] = c[i] * scale[i] * scale[j];
+  }
+  return true;
+}
+
+/* most sight pairs tried for a starting point by the robust fix */
+static const int s_RansacSamples = 500;
+
+/* tuning of the robust weights, for residuals in standard deviations */
+static const double s_Huber = 1.345, s_Tukey = 4.685;
+
+/* Robust fix for sight sets with blunders.  Circles through pairs of sights
+   (RANSAC) find a starting point most sights agree with, then iteratively
+   reweighted least squares refines it, first with Huber weights and then
+   with Tukey's biweight, which gives the sights it rejects no weight */
+bool FixEngine::SolveRobust(double& lat, double& lon, double& error) {
+  /* the contributions laid out flat so the residuals of every sight are a
+     pass over contiguous arrays */
+  std::vector<Entry*> entries;
+  std::vector<double> gx, gy, gz, sm, w, inv;
+  for (auto& it : m_Entries) {
+    Entry& e = it.second;
+    e.outlier = false;
+    if (!e.count) continue;
+    entries.push_back(&e);
+    gx.push_back(e.c.x), gy.push_back(e.c.y), gz.push_back(e.c.z);
+    sm.push_back(e.c.sm);
+
+    /* standard deviation of the altitude, no finer than a minute so
+       certainties that are stated too fine don't reject every sight */
+    double ca = wxMax(sqrt(1 - e.c.sm * e.c.sm), .01);
+    double sd = wxMax(1 / (sqrt(e.c.w) * ca), d_to_r(1.0 / 60));
+    inv.push_back(1 / (sd * ca));
+    w.push_back(e.count * inv.back() * inv.back());
+  }
+  int n = entries.size();
+  if (n < 2) return false;
+
+  /* residuals in standard deviations at X */
+  std::vector<double> u(n);
+  auto residuals = [&](const double X[3]) {
+    for (int k = 0; k < n; k++)
+      u[k] = (sm[k] - X[0] * gx[k] - X[1] * gy[k] - X[2] * gz[k]) * inv[k];
+  };
+
+  double X[3];
+  X[0] = cos(d_to_r(lat)) * cos(d_to_r(lon));
+  X[1] = cos(d_to_r(lat)) * sin(d_to_r(lon));
+  X[2] = sin(d_to_r(lat));
+
+  if (n >= 3) {
+    /* every pair when there are few enough, otherwise random pairs until
+       it is likely one had no blunder */
+    int pairs = n * (n - 1) / 2, samples = wxMin(pairs, s_RansacSamples);
+    bool all = pairs <= s_RansacSamples;
+    std::mt19937 random(1);
+    double best = INFINITY;
+    for (int t = 0, i = 0, j = 1; t < samples; t++) {
+      int a = i, b = j;
+      if (all) {
+        if (++j == n) i++, j = i + 1;
+      } else {
+        a = random() % n, b = random() % (n - 1);
+        if (b >= a) b++;
+      }
+
+      /* the circles meet where X = p g_a + q g_b + r (g_a x g_b) */
+      double ga[3] = {gx[a], gy[a], gz[a]}, gb[3] = {gx[b], gy[b], gz[b]};
+      double d = dot3(ga, gb), det = 1 - d * d;
+      if (det < 1e-6) continue;  // the same or opposite positions
+      double p = (sm[a] - sm[b] * d) / det, q = (sm[b] - sm[a] * d) / det;
+      double c[3] = {ga[1] * gb[2] - ga[2] * gb[1],
+                     ga[2] * gb[0] - ga[0] * gb[2],
+                     ga[0] * gb[1] - ga[1] * gb[0]};
+      /* where they don't meet, the point between them */
+      double r = sqrt(wxMax(1 - (p * p + q * q + 2 * p * q * d), 0.0) / det);
+
+      for (int side = -1; side <= 1; side += 2) {
+        double Y[3];
+        for (int k = 0; k < 3; k++)
+          Y[k] = p * ga[k] + q * gb[k] + side * r * c[k];
+        double l = sqrt(dot3(Y, Y));
+        Y[0] /= l, Y[1] /= l, Y[2] /= l;
+
+        /* truncated squares, given up as soon as it can't beat the best */
+        double loss = 0;
+        int inliers = 0;
+        for (int k = 0; k < n && loss < best; k++) {
+          double e = (sm[k] - Y[0] * gx[k] - Y[1] * gy[k] - Y[2] * gz[k]) *
+                     inv[k];
+          if (e * e < 9)
+            loss += e * e, inliers++;
+          else
+            loss += 9;
+        }
+        if (loss >= best) continue;
+
+        best = loss;
+        X[0] = Y[0], X[1] = Y[1], X[2] = Y[2];
+        if (!all) {
+          double f = (double)inliers / n;
+          double needed = log(.01) / log(wxMax(1 - f * f, 1e-9));
+          samples = wxMin(samples, wxMax(t + 1, (int)ceil(needed)));
+        }
+      }
+    }
+  }
+
+  std::vector<double> rho(n), a(n);
+  double sigma = 1, d = 1, err = NAN, R2 = 0, W = 0;
+  bool tukey = false;
+  const int max_iterations = 50;
+  for (int iterations = 0; iterations < max_iterations; iterations++) {
+    residuals(X);
+
+    /* scale from the median residual, no finer than the certainties */
+    for (int k = 0; k < n; k++) a[k] = fabs(u[k]);
+    std::nth_element(a.begin(), a.begin() + n / 2, a.end());
+    sigma = wxMax(1.4826 * a[n / 2], 1.0);
+
+    int kept = 0;
+    for (int k = 0; k < n; k++) {
+      double v = fabs(u[k]) / sigma;
+      if (tukey) {
+        double t = v / s_Tukey;
+        rho[k] = t < 1 ? (1 - t * t) * (1 - t * t) : 0;
+      } else
+        rho[k] = v <= s_Huber ? 1 : s_Huber / v;
+      if (rho[k] > 0) kept++;
+    }
+    if (kept < 2) return false;
+
+    /* weighted plane rows */
+    double S[3][3] = {{0}}, N[3] = {0};
+    W = R2 = 0;
+    for (int k = 0; k < n; k++) {
+      double wk = w[k] * rho[k], g[3] = {gx[k], gy[k], gz[k]};
+      double dk = u[k] / inv[k];
+      for (int i = 0; i < 3; i++) {
+        for (int j = i; j < 3; j++) S[i][j] += wk * g[i] * g[j];
+        N[i] += wk * g[i] * dk;
+      }
+      W += wk;
+      R2 += wk * dk * dk;
+    }
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < i; j++) S[i][j] = S[j][i];
+
+    for (int i = 0; i < 3; i++)
+      for (int j = 0; j < 3; j++) m_RobustA[i][j] = S[i][j] / (sigma * sigma);
+
+    /* fit to unit sphere, weighted as an average sight kept */
+    double wm = W / kept, e = 1 - dot3(X, X);
+    for (int i = 0; i < 3; i++) {
+      for (int j = 0; j < 3; j++) S[i][j] += 4 * wm * X[i] * X[j];
+      N[i] += 2 * wm * X[i] * e;
+    }
+    R2 = (R2 + wm * e * e) / wm;
+
+    double dX[3];
+    if (!ldlt_solve<3>(S, N, dX)) return false;
+    X[0] += dX[0], X[1] += dX[1], X[2] += dX[2];
+
+    d = sqrt(dot3(X, X));
+    err = fabs(d - 1);
+    if (err > 100) /* we are diverging */
+      return false;
+
+    /* converge with Huber weights before rejecting anything */
+    if (dot3(dX, dX) < 1e-20) {
+      if (tukey) break;
+      tukey = true;
+    }
+  }
+
+  if (!(err <= .1)) return false;
+
+  X[0] /= d, X[1] /= d, X[2] /= d;
+  lat = r_to_d(asin(X[2]));
+  lon = r_to_d(atan2(X[1], X[0]));
+  error = sqrt(wxMax(R2, 0.0));
+
+  for (int k = 0; k < n; k++) entries[k]->outlier = rho[k] == 0;
+  m_bRobust = true;
+  return true;
+}
+
+/* spacing in degrees of the grid the search looks over, and the most local
+   minima of it that are refined */
+static const double s_SearchStep = 2;
+static const int s_SearchStarts = 16;
+/* candidates closer than this in degrees are the same fix */
+static const double s_SearchTolerance = .02;
+
+void FixEngine::Search(int algorithm, std::vector<Candidate>& candidates) {
+  candidates.clear();
+  if (Count() < 2) return;
+
+  /* each body was above the horizon, so the observer is within 90 degrees
+     of every geographic position and so of their weighted mean.  The grid
+     is rings about the mean, with a margin so a fix on the edge is still
+     a minimum inside it */
+  double c[3] = {m_G[0], m_G[1], m_G[2]};
+  double len = sqrt(dot3(c, c)), extent = 90 + s_SearchStep;
+  if (!(len > 1e-3 * m_W)) {  // no mean, look everywhere
+    c[0] = c[1] = 0, c[2] = len = 1;
+    extent = 180;
+  }
+  for (int i = 0; i < 3; i++) c[i] /= len;
+
+  double e1[3], e2[3], axis[3] = {0, 0, 1};
+  if (fabs(c[2]) > .9) axis[0] = 1, axis[2] = 0;
+  cross3(c, axis, e1);
+  double l1 = sqrt(dot3(e1, e1));
+  for (int i = 0; i < 3; i++) e1[i] /= l1;
+  cross3(c, e1, e2);
+
+  const int azimuths = (int)(360 / s_SearchStep);
+  int rings = (int)ceil(extent / s_SearchStep);
+  std::vector<double> ca(azimuths), sa(azimuths);
+  for (int j = 0; j < azimuths; j++) {
+    ca[j] = cos(d_to_r(j * s_SearchStep));
+    sa[j] = sin(d_to_r(j * s_SearchStep));
+  }
+
+  /* the plane residual of every node from the sums, so the grid costs the
+     same however many sights there are */
+  std::vector<double> v(rings * azimuths);
+  std::vector<double> nodes(3 * rings * azimuths);
+  for (int i = 0; i < rings; i++) {
+    double d = d_to_r(wxMin((i + .5) * s_SearchStep, 180.0));
+    double cd = cos(d), sd = sin(d);
+    for (int j = 0; j < azimuths; j++) {
+      double* p = &nodes[3 * (i * azimuths + j)];
+      for (int k = 0; k < 3; k++)
+        p[k] = c[k] * cd + (e1[k] * ca[j] + e2[k] * sa[j]) * sd;
+      double Ap[3] = {dot3(m_A[0], p), dot3(m_A[1], p), dot3(m_A[2], p)};
+      v[i * azimuths + j] = dot3(p, Ap) - 2 * dot3(m_B, p) + m_C;
+    }
+  }
+
+  /* nodes below all eight neighbours, ties going to the first */
+  std::vector<std::pair<double, int>> minima;
+  for (int i = 0; i < rings; i++)
+    for (int j = 0; j < azimuths; j++) {
+      int k = i * azimuths + j;
+      bool least = true;
+      for (int di = -1; di <= 1 && least; di++) {
+        int ii = i + di;
+        if (ii < 0 || ii >= rings) continue;
+        for (int dj = -1; dj <= 1; dj++) {
+          int kk = ii * azimuths + (j + dj + azimuths) % azimuths;
+          if (kk != k && (v[kk] < v[k] || (v[kk] == v[k] && kk < k))) {
+            least = false;
+            break;
+          }
+        }
+      }
+      if (least) minima.push_back(std::make_pair(v[k], k));
+    }
+  std::sort(minima.begin(), minima.end());
+  if (minima.size() > (size_t)s_SearchStarts) minima.resize(s_SearchStarts);
+
+  /* refining must not lose what the last robust solve found */
+  bool robust = m_bRobust;
+  if (algorithm == ROBUST) algorithm = SPHERE;
+  for (auto& m : minima) {
+    const double* p = &nodes[3 * m.second];
+    Candidate f;
+    f.lat = r_to_d(asin(p[2]));
+    f.lon = r_to_d(atan2(p[1], p[0]));
+    if (!Solve(algorithm, f.lat, f.lon, f.error)) continue;
+
+    bool found = false;
+    for (Candidate& g : candidates)
+      if (fabs(f.lat - g.lat) < s_SearchTolerance &&
+          fabs(resolve_heading(f.lon - g.lon)) * cos(d_to_r(f.lat)) <
+              s_SearchTolerance) {
+        if (f.error < g.error) g = f;
+        found = true;
+        break;
+      }
+    if (!found) candidates.push_back(f);
+  }
+  m_bRobust = robust;
+
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) {
+              return a.error < b.error;
+            });
+}
+
+bool FixEngine::Covariance(double lat, double lon, double C[2][2]) {
+  if (Count() < 2) return false;
+
+  /* east and north at the fix.  A row changes by g along them per radian
+     moved, so the information of the position is A projected on them */
+  double slat = sin(d_to_r(lat)), clat = cos(d_to_r(lat));
+  double slon = sin(d_to_r(lon)), clon = cos(d_to_r(lon));
+  double T[2][3] = {{-slon, clon, 0}, {-slat * clon, -slat * slon, clat}};
+
+  const double(*A)[3] = m_bRobust ? m_RobustA : m_A;
+  double M[2][2];
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 2; j++) {
+      double AT[3];
+      for (int k = 0; k < 3; k++) AT[k] = dot3(A[k], T[j]);
+      M[i][j] = dot3(T[i], AT);
+    }
+
+  double det = M[0][0] * M[1][1] - M[0][1] * M[1][0];
+  if (!(det > 1e-12 * (M[0][0] * M[0][0] + M[1][1] * M[1][1]))) return false;
+
+  double nm = r_to_d(1) * 60, nm2 = nm * nm;  // radians to nautical miles
+  C[0][0] = M[1][1] / det * nm2;
+  C[1][1] = M[0][0] / det * nm2;
+  C[0][1] = C[1][0] = -M[0][1] / det * nm2;
+  return true;
+}
+
+void FixEngine::Ellipse(const double C[2][2], double p, double& major,
+                        double& minor, double& bearing) {
+  /* eigenvalues of the covariance are the variances along the axes */
+  double m = (C[0][0] + C[1][1]) / 2, dd = (C[0][0] - C[1][1]) / 2;
+  double r = sqrt(dd * dd + C[0][1] * C[0][1]);
+
+  /* the squared radius holding p of a 2d normal distribution */
+  double k = -2 * log(1 - p);
+  major = sqrt(k * (m + r));
+  minor = sqrt(k * wxMax(m - r, 0.0));
+
+  /* angle of the major axis from east, counterclockwise */
+  double angle = r_to_d(atan2(C[0][1], dd) / 2);
+  bearing = resolve_heading_positive(90 - angle);
+  if (bearing >= 180) bearing -= 180;
+}
@@ -0,0 +1,194 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#ifndef _FIXENGINE_H_
+#define _FIXENGINE_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Sight;
+class wxDateTime;
+
+/* what the fix needs from an altitude sight: the unit vector to the body's
+   geographic position, the sine of the observed altitude, the weight of
+   its row, the inverse variance of that sine, and the rates in radians per
+   second its hour angle and declination grow */
+struct FixContribution {
+  double x, y, z;
+  double sm;
+  double w;
+  double rate, decrate;
+};
+
+/* Least squares fix kept up to date as sights change.  The ephemeris is
+   looked up once per sight, and the sums the normal equations are built
+   from are kept as running totals, so adding, removing or changing a
+   sight is O(1) and a solve does not depend on the number of sights. */
+class FixEngine {
+public:
+  /* in the order of the fix dialog's choices */
+  enum Algorithm { PLANE, SPHERE, CONE, CONE2, ROBUST };
+
+  FixEngine();
+
+  /* bring the contributions in line with the visible altitude sights,
+     only sights not already held are looked up in the ephemeris.  Shifted
+     sights are moved about lat, lon, which should be near the fix.
+     Returns true if there were shifted sights, in which case it is worth
+     updating again about the fix if it was far from lat, lon */
+  bool Update(std::vector<Sight>& sights, int clock_offset, double lat,
+              double lon);
+
+  /* contribution of a body at gplat, gplon observed at altitude, with
+     the certainties of the altitude in minutes of arc and of the time in
+     seconds, and the rates its hour angle and declination grow in degrees
+     per hour */
+  static FixContribution Contribution(double gplat, double gplon,
+                                      double altitude, double certainty,
+                                      double timecertainty, double rate,
+                                      double decrate = 0);
+
+  /* rates in degrees per hour the hour angle and declination of the body
+     of s grow at time, from the ephemeris a minute either side */
+  static void Rates(Sight& s, const wxDateTime& time, double& rate,
+                    double& decrate);
+
+  /* c with its geographic position where the body is seconds later */
+  static FixContribution Later(const FixContribution& c, double seconds);
+
+  /* c with its line of position moved nm nautical miles toward the true
+     bearing, for a running fix with the boat at lat, lon.  The geographic
+     position is turned so the point of the line nearest where the boat
+     was makes that move exactly, the rest of the line follows it as a
+     rigid body */
+  static FixContribution Shift(const FixContribution& c, double lat,
+                               double lon, double nm, double bearing);
+
+  /* the sums can also be kept directly when Update is not used */
+  void Add(const FixContribution& c) { Accumulate(c, 1); }
+  void Remove(const FixContribution& c) { Accumulate(c, -1); }
+  void Clear();
+  int Count() const { return (int)(m_n + .5); }
+
+  /* weighted gauss-newton from lat, lon with one of the fix algorithms,
+     replaced by the fix.  False if there are fewer than 2 sights or it
+     does not converge.  ROBUST only sees contributions from Update */
+  bool Solve(int algorithm, double& lat, double& lon, double& error);
+
+  /* a fix found by Search, with the error Solve gives it */
+  struct Candidate {
+    double lat, lon, error;
+  };
+
+  /* every fix of the sights wherever it is, for when there is no position
+     to start from or the sights fit more than one, as two bodies do where
+     their circles cross twice.  The residuals are looked at on a coarse
+     grid over the hemisphere the sights must have been taken from, and
+     Solve is started from each local minimum, with the sphere for ROBUST.
+     The candidates are sorted by error, none if there are fewer than 2
+     sights */
+  void Search(int algorithm, std::vector<Candidate>& candidates);
+
+  /* solve for the error of the clock along with the position.  A clock
+     error turns every geographic position about the pole alike, which
+     altitudes can't tell from a change of longitude, so the clock is found
+     from the moon moving against the stars, or from a known position
+     dr_lat, dr_lon good to dr_sd nautical miles (none if dr_sd is 0).
+     clock is the correction in seconds to add to the sight times, from 0
+     or the last estimate, and C the covariance of the east and north
+     errors in nautical miles and the clock in seconds.  Uses the plane
+     rows, and like ROBUST only sees contributions from Update.  False if
+     the sights don't fix the clock */
+  bool SolveClock(double& lat, double& lon, double& error, double& clock,
+                  double C[3][3], double dr_lat = 0, double dr_lon = 0,
+                  double dr_sd = 0);
+
+  /* the contribution from Update of a sight, false if it isn't held */
+  bool Find(Sight& s, int clock_offset, FixContribution& c);
+
+  /* the contributions from Update now in the sums, shifted ones as moved */
+  void Contributions(std::vector<FixContribution>& c) const;
+
+  /* whether the last robust solve rejected a sight */
+  bool IsOutlier(Sight& s, int clock_offset);
+
+  /* covariance in square nautical miles of the east and north errors of
+     a fix at lat, lon, false if the lines of position are parallel */
+  bool Covariance(double lat, double lon, double C[2][2]);
+
+  /* semi-axes in nautical miles and true bearing of the major axis of the
+     error ellipse holding probability p of a covariance */
+  static void Ellipse(const double C[2][2], double p, double& major,
+                      double& minor, double& bearing);
+
+private:
+  struct Key {
+    std::wstring body;
+    long long ticks;  // time of the sight with the clock offset applied
+    double altitude;  // observed
+    double certainty, timecertainty;
+    double shiftnm, shiftbearing;
+    bool magnetic;
+    bool operator==(const Key& k) const {
+      return body == k.body && ticks == k.ticks && altitude == k.altitude &&
+             certainty == k.certainty && timecertainty == k.timecertainty &&
+             shiftnm == k.shiftnm && shiftbearing == k.shiftbearing &&
+             magnetic == k.magnetic;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key& k) const;
+  };
+  struct Entry {
+    FixContribution c;
+    FixContribution gp;  // before any shift
+    double about[3];     // where the shift was made
+    int count;  // sights with this key now in the sums
+    int used;   // sights with this key seen by this update
+    bool outlier;
+  };
+
+  static Key MakeKey(Sight& s, int clock_offset);
+  void Accumulate(const FixContribution& c, double sign);
+  void Resum();
+  bool SolveRobust(double& lat, double& lon, double& error);
+
+  std::unordered_map<Key, Entry, KeyHash> m_Entries;
+  int m_Removed;  // since the sums were last rebuilt
+
+  /* number of contributions and their weighted sums of 1, g, g gt, sm, sm g
+     and sm^2 where g is the vector to the geographic position */
+  double m_n;
+  double m_W, m_G[3], m_A[3][3], m_s, m_B[3], m_C;
+
+  /* information of the last robust fix, from the weights it kept */
+  bool m_bRobust;
+  double m_RobustA[3][3];
+};
+
+#endif  // _FIXENGINE_H_
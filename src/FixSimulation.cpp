@@ -0,0 +1,172 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif
+
+#include <cmath>
+#include <random>
+
+#include "FixSimulation.h"
+#include "Sight.h"
+#include "SightWorkerPool.h"
+#include "celestial_navigation_pi.h"
+
+/* standard deviations of the inputs a sight has no certainty for: the index
+   error in minutes of arc, the eye height in meters as the boat moves, and
+   the temperature and pressure used for refraction */
+static const double s_IndexErrorCertainty = .1;
+static const double s_EyeHeightCertainty = .5;
+static const double s_TemperatureCertainty = 5;
+static const double s_PressureCertainty = 10;
+
+/* samples in each task */
+static const int s_TaskSamples = 250;
+
+FixSimulation::FixSimulation()
+    : m_pWorkers(NULL), m_Algorithm(FixEngine::SPHERE), m_Lat(0), m_Lon(0) {}
+
+FixSimulation::~FixSimulation() { delete m_pWorkers; }
+
+FixSimulation::Input FixSimulation::MakeInput(Sight& s,
+                                              const FixContribution& c) {
+  Input in;
+  in.c = c;
+  in.altitude = s.m_ObservedAltitude;
+  in.certainty = s.m_MeasurementCertainty;
+  in.timecertainty = s.m_TimeCertainty;
+  in.scale = s.m_MeasurementScale;
+  in.eyeheight = s.m_ArtificialHorizon ? NAN : s.m_EyeHeight;
+  in.dipshortdistance = s.m_DipShort ? s.m_DipShortDistance : 0;
+  in.dip = s.m_ArtificialHorizon
+               ? 0
+               : Sight::Dip(in.eyeheight, in.dipshortdistance);
+  in.refraction = s.m_RefractionCorrection;
+  in.temperature = s.m_Temperature;
+  in.pressure = s.m_Pressure;
+  return in;
+}
+
+int FixSimulation::Run(const std::vector<Input>& inputs, int algorithm,
+                       double lat, double lon, int samples) {
+  m_Inputs = inputs;
+  /* a robust solve needs the sights held by Update, the samples are fit by
+     the sphere instead */
+  m_Algorithm = algorithm == FixEngine::ROBUST ? FixEngine::SPHERE : algorithm;
+  m_Lat = lat, m_Lon = lon;
+  m_Points.resize(samples);
+
+  if (!m_pWorkers) m_pWorkers = new SightWorkerPool;
+  for (int begin = 0; begin < samples; begin += s_TaskSamples) {
+    int end = wxMin(begin + s_TaskSamples, samples);
+    m_pWorkers->Submit([=] { RunSamples(begin, end, begin + 1); });
+  }
+  m_pWorkers->Wait();
+
+  int count = 0;
+  for (const wxRealPoint& p : m_Points)
+    if (!std::isnan(p.x)) count++;
+  return count;
+}
+
+/* the samples from begin to end, from a generator of their own so the
+   results don't depend on how the tasks ran */
+void FixSimulation::RunSamples(int begin, int end, unsigned int seed) {
+  std::mt19937 random(seed);
+  std::normal_distribution<double> normal;
+  FixEngine engine;
+
+  for (int n = begin; n < end; n++) {
+    /* the index error, eye height and weather are the same for every sight
+       of a fix, so each sample draws their errors once and moves all the
+       lines by them together */
+    double indexerror = normal(random) * s_IndexErrorCertainty;
+    double eyeheight = normal(random) * s_EyeHeightCertainty;
+    double temperature = normal(random) * s_TemperatureCertainty;
+    double pressure = normal(random) * s_PressureCertainty;
+
+    engine.Clear();
+    for (const Input& in : m_Inputs) {
+      double measured = (normal(random) * in.certainty - indexerror) / 60;
+
+      double dip = 0;
+      if (!std::isnan(in.eyeheight)) {
+        double height = wxMax(in.eyeheight + eyeheight, 0.0);
+        dip = Sight::Dip(height, in.dipshortdistance) - in.dip;
+      }
+
+      /* refraction goes as pressure over absolute temperature */
+      double refraction = 0;
+      if (in.pressure > 0) {
+        double t = in.temperature + temperature;
+        double p = in.pressure + pressure;
+        double ratio =
+            p / in.pressure * (in.temperature + 273.15) / (t + 273.15);
+        refraction = in.refraction * (ratio - 1);
+      }
+
+      double altitude = in.altitude + in.scale * (measured - dip) - refraction;
+
+      /* a later time moves the geographic position along the body's path */
+      FixContribution c =
+          FixEngine::Later(in.c, normal(random) * in.timecertainty);
+      c.sm = sin(d_to_r(altitude));
+      engine.Add(c);
+    }
+
+    double lat = m_Lat, lon = m_Lon, error;
+    if (engine.Solve(m_Algorithm, lat, lon, error))
+      m_Points[n] = wxRealPoint(lat, lon);
+    else
+      m_Points[n] = wxRealPoint(NAN, NAN);
+  }
+}
+
+bool FixSimulation::Spread(double& lat, double& lon, double C[2][2]) const {
+  /* in nautical miles east and north of where the samples started */
+  double coslat = cos(d_to_r(m_Lat));
+  double n = 0, east = 0, north = 0, ee = 0, en = 0, nn = 0;
+  for (const wxRealPoint& p : m_Points) {
+    if (std::isnan(p.x)) continue;
+    double x = resolve_heading(p.y - m_Lon) * coslat * 60;
+    double y = (p.x - m_Lat) * 60;
+    n++;
+    east += x, north += y;
+    ee += x * x, en += x * y, nn += y * y;
+  }
+  if (n < 3) return false;
+
+  east /= n, north /= n;
+  C[0][0] = (ee - n * east * east) / (n - 1);
+  C[0][1] = C[1][0] = (en - n * east * north) / (n - 1);
+  C[1][1] = (nn - n * north * north) / (n - 1);
+  lat = m_Lat + north / 60;
+  lon = resolve_heading(m_Lon + east / (60 * coslat));
+  return true;
+}
@@ -0,0 +1,90 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#ifndef _FIXSIMULATION_H_
+#define _FIXSIMULATION_H_
+
+#include <vector>
+
+#include <wx/gdicmn.h>
+
+#include "FixEngine.h"
+
+class Sight;
+class SightWorkerPool;
+
+/* Monte Carlo spread of a fix.  Each sample draws new errors for every
+   sight's measurement, time, index error, eye height, temperature and
+   pressure, carries them through to the observed altitude and geographic
+   position, and solves the fix again.  Samples are spread over worker
+   threads, each with a fix engine whose sums are refilled in place, so a
+   sample allocates nothing and costs little more than the solve. */
+class FixSimulation {
+public:
+  /* what the samples of an altitude sight are drawn from */
+  struct Input {
+    FixContribution c;     // as in the fix
+    double altitude;       // observed, in degrees
+    double certainty;      // of the measurement, in minutes of arc
+    double timecertainty;  // in seconds
+    double scale;          // change of the observed altitude per measured
+    double eyeheight;      // meters, NaN with an artificial horizon
+    double dipshortdistance;
+    double dip, refraction;  // as applied, in degrees
+    double temperature, pressure;
+  };
+
+  FixSimulation();
+  ~FixSimulation();
+
+  /* input for a sight whose contribution to the fix is c */
+  static Input MakeInput(Sight& s, const FixContribution& c);
+
+  /* solve samples fixes with one of the fix algorithms, each from lat,
+     lon which should be the fix.  Returns how many converged */
+  int Run(const std::vector<Input>& inputs, int algorithm, double lat,
+          double lon, int samples);
+  void Clear() { m_Points.clear(); }
+
+  /* latitude (x) and longitude (y) of each sample, NaN if it failed */
+  const std::vector<wxRealPoint>& Points() const { return m_Points; }
+
+  /* mean of the samples and covariance of their east and north spread in
+     square nautical miles, false with fewer than 3 */
+  bool Spread(double& lat, double& lon, double C[2][2]) const;
+
+private:
+  void RunSamples(int begin, int end, unsigned int seed);
+
+  SightWorkerPool* m_pWorkers;  // started when first needed
+
+  std::vector<Input> m_Inputs;
+  int m_Algorithm;
+  double m_Lat, m_Lon;
+  std::vector<wxRealPoint> m_Points;
+};
+
+#endif  // _FIXSIMULATION_H_
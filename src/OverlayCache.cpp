@@ -0,0 +1,357 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif
+
+#include <wx/dcgraph.h>
+#include <cmath>
+#include <cstring>
+
+#include "OverlayCache.h"
+#include "Sight.h"
+
+#ifdef USE_ANDROID_GLES2
+#include "pi_shaders.h"
+#endif
+
+OverlayCache::OverlayCache()
+    : m_bValid(false),
+      m_bGL(false),
+      m_pix_per_mm(0),
+      m_MarginX(0),
+      m_MarginY(0),
+      m_Texture(0),
+      m_TextureWidth(0),
+      m_TextureHeight(0) {
+#ifdef USE_ANDROID_GLES2
+  m_Framebuffer = 0;
+#endif
+}
+
+OverlayCache::~OverlayCache() {
+#ifdef USE_ANDROID_GLES2
+  if (m_Framebuffer) glDeleteFramebuffers(1, &m_Framebuffer);
+#endif
+  if (m_Texture) glDeleteTextures(1, &m_Texture);
+}
+
+bool OverlayCache::Render(piDC* dc, PlugIn_ViewPort& VP,
+                          const std::vector<Sight*>& sights, double pix_per_mm,
+                          const Painter& paint, bool* cached) {
+  bool gl = !dc->GetDC();
+  std::vector<Key> keys;
+  for (Sight* s : sights) {
+    Key key = {s->m_GeometryId, s->m_Colour.GetRGBA()};
+    keys.push_back(key);
+  }
+
+  wxPoint2DDouble offset;
+  bool current = m_bValid && m_bGL == gl && keys == m_Keys &&
+                 m_pix_per_mm == pix_per_mm && Offset(VP, offset);
+  if (cached) *cached = current;
+
+  if (!current) {
+    m_bValid = false;
+    m_VP = VP;
+    Enlarge(m_VP);
+    if (gl ? !PaintTexture(dc, VP, paint) : !PaintBitmap(paint)) return false;
+    m_bValid = true;
+    m_bGL = gl;
+    m_Keys.swap(keys);
+    m_pix_per_mm = pix_per_mm;
+    offset = wxPoint2DDouble(-m_MarginX, -m_MarginY);
+  }
+
+  if (gl)
+    DrawTexture(offset);
+  else
+    DrawBitmap(dc, offset);
+  return true;
+}
+
+/* where the image goes on screen for this viewport, false if it has to be
+   redrawn */
+bool OverlayCache::Offset(PlugIn_ViewPort& VP, wxPoint2DDouble& offset) {
+  if (VP.m_projection_type != m_VP.m_projection_type ||
+      VP.view_scale_ppm != m_VP.view_scale_ppm ||
+      VP.rotation != m_VP.rotation || VP.skew != m_VP.skew ||
+      VP.pix_width + 2 * m_MarginX != m_VP.pix_width ||
+      VP.pix_height + 2 * m_MarginY != m_VP.pix_height)
+    return false;
+
+  /* only a mercator chart pans as a translation of the screen */
+  if (VP.m_projection_type != PI_PROJECTION_MERCATOR &&
+      (VP.clat != m_VP.clat || VP.clon != m_VP.clon))
+    return false;
+
+  wxPoint2DDouble center;
+  GetDoubleCanvasPixLL(&VP, &center, m_VP.clat, m_VP.clon);
+  offset.m_x = center.m_x - m_VP.pix_width / 2.0;
+  offset.m_y = center.m_y - m_VP.pix_height / 2.0;
+  return offset.m_x <= 0 && offset.m_x >= -2 * m_MarginX &&
+         offset.m_y <= 0 && offset.m_y >= -2 * m_MarginY;
+}
+
+/* grow the viewport by the margin on every side, keeping its center */
+void OverlayCache::Enlarge(PlugIn_ViewPort& VP) {
+  m_MarginX = VP.pix_width / 4;
+  m_MarginY = VP.pix_height / 4;
+  VP.pix_width += 2 * m_MarginX;
+  VP.pix_height += 2 * m_MarginY;
+  VP.rv_rect = wxRect(0, 0, VP.pix_width, VP.pix_height);
+
+  if (!VP.bValid) return;
+
+  /* without bounds nothing is culled, which is only slower */
+  if (VP.m_projection_type != PI_PROJECTION_MERCATOR) {
+    VP.bValid = false;
+    return;
+  }
+
+  /* on mercator the corners are the extremes, with longitudes unwrapped
+     from the center */
+  double latmin = 90, latmax = -90, lonmin = 180, lonmax = -180;
+  for (int i = 0; i < 4; i++) {
+    wxPoint p(i & 1 ? VP.pix_width : 0, i & 2 ? VP.pix_height : 0);
+    double lat, lon;
+    GetCanvasLLPix(&VP, p, &lat, &lon);
+    lon = resolve_heading(lon - VP.clon);
+    latmin = wxMin(latmin, lat);
+    latmax = wxMax(latmax, lat);
+    lonmin = wxMin(lonmin, lon);
+    lonmax = wxMax(lonmax, lon);
+  }
+  VP.lat_min = wxMax(-90.0, latmin);
+  VP.lat_max = wxMin(90.0, latmax);
+
+  /* unwrapping is ambiguous once the view reaches around the world */
+  wxPoint2DDouble p0, p1;
+  GetDoubleCanvasPixLL(&VP, &p0, VP.clat, VP.clon);
+  GetDoubleCanvasPixLL(&VP, &p1, VP.clat, VP.clon + 1);
+  double pix_per_degree = hypot(p1.m_x - p0.m_x, p1.m_y - p0.m_y);
+  if (360 * pix_per_degree <= hypot(VP.pix_width, VP.pix_height)) {
+    VP.lon_min = -180;
+    VP.lon_max = 180;
+  } else {
+    VP.lon_min = resolve_heading(VP.clon + lonmin);
+    VP.lon_max = resolve_heading(VP.clon + lonmax);
+  }
+}
+
+bool OverlayCache::PaintBitmap(const Painter& paint) {
+#if wxUSE_GRAPHICS_CONTEXT
+  /* a transparent image drawn through a graphics context keeps the alpha of
+     the sight colours on every platform */
+  wxImage image(m_VP.pix_width, m_VP.pix_height);
+  image.InitAlpha();
+  memset(image.GetAlpha(), 0, m_VP.pix_width * m_VP.pix_height);
+  m_Bitmap = wxBitmap(image, 32);
+
+  wxMemoryDC mdc(m_Bitmap);
+  if (!mdc.IsOk()) return false;
+  {
+    wxGCDC gdc(mdc);
+    piDC pdc;
+    pdc.SetDC(&gdc);
+    paint(&pdc, m_VP);
+  }
+  mdc.SelectObject(wxNullBitmap);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void OverlayCache::DrawBitmap(piDC* dc, const wxPoint2DDouble& offset) {
+  dc->GetDC()->DrawBitmap(m_Bitmap, wxRound(offset.m_x), wxRound(offset.m_y),
+                          true);
+}
+
+#ifndef USE_ANDROID_GLES2
+/* the sights are drawn into the bitmap as on a wxDC, and its pixels uploaded
+   once for the frames that only pan */
+bool OverlayCache::PaintTexture(piDC* dc, PlugIn_ViewPort& VP,
+                                const Painter& paint) {
+  int w = m_VP.pix_width, h = m_VP.pix_height;
+  GLint maxsize;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxsize);
+  if (w > maxsize || h > maxsize || !PaintBitmap(paint)) return false;
+
+  wxImage image = m_Bitmap.ConvertToImage();
+  m_Bitmap = wxNullBitmap;
+  if (!image.HasAlpha()) return false;
+  std::vector<unsigned char> pixels(4 * w * h);
+  unsigned char *rgb = image.GetData(), *alpha = image.GetAlpha();
+  for (int i = 0; i < w * h; i++) {
+    pixels[4 * i] = rgb[3 * i];
+    pixels[4 * i + 1] = rgb[3 * i + 1];
+    pixels[4 * i + 2] = rgb[3 * i + 2];
+    pixels[4 * i + 3] = alpha[i];
+  }
+
+  if (!m_Texture) glGenTextures(1, &m_Texture);
+  glBindTexture(GL_TEXTURE_2D, m_Texture);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  if (w != m_TextureWidth || h != m_TextureHeight) {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, &pixels[0]);
+    m_TextureWidth = w;
+    m_TextureHeight = h;
+  } else
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE,
+                    &pixels[0]);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return true;
+}
+
+void OverlayCache::DrawTexture(const wxPoint2DDouble& offset) {
+  float x0 = wxRound(offset.m_x), y0 = wxRound(offset.m_y);
+  float x1 = x0 + m_TextureWidth, y1 = y0 + m_TextureHeight;
+  float coords[] = {x0, y0, x1, y0, x0, y1, x1, y1};
+  float uv[] = {0, 0, 1, 0, 0, 1, 1, 1};
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glEnable(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, m_Texture);
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glVertexPointer(2, GL_FLOAT, 0, coords);
+  glTexCoordPointer(2, GL_FLOAT, 0, uv);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDisable(GL_TEXTURE_2D);
+  glDisable(GL_BLEND);
+}
+#else
+bool OverlayCache::PaintTexture(piDC* dc, PlugIn_ViewPort& VP,
+                                const Painter& paint) {
+  int w = m_VP.pix_width, h = m_VP.pix_height;
+  GLint maxsize;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxsize);
+  if (w > maxsize || h > maxsize) return false;
+
+  if (!m_Texture) glGenTextures(1, &m_Texture);
+  if (w != m_TextureWidth || h != m_TextureHeight) {
+    glBindTexture(GL_TEXTURE_2D, m_Texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA,
+                 GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_TextureWidth = w;
+    m_TextureHeight = h;
+  }
+
+  /* the canvas may itself be drawing into a framebuffer */
+  GLint framebuffer, viewport[4];
+  GLfloat clear[4];
+  glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  glGetFloatv(GL_COLOR_CLEAR_VALUE, clear);
+  GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+
+  if (!m_Framebuffer) glGenFramebuffers(1, &m_Framebuffer);
+  glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         m_Texture, 0);
+  bool complete =
+      glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+  if (complete) {
+    glDisable(GL_SCISSOR_TEST);
+    glViewport(0, 0, w, h);
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    /* colours are stored premultiplied with the alpha as coverage, so the
+       image composites the same as drawing the sights directly */
+    dc->SetVP(&m_VP);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                        GL_ONE_MINUS_SRC_ALPHA);
+    paint(dc, m_VP);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    dc->SetVP(&VP);
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+  glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+  glClearColor(clear[0], clear[1], clear[2], clear[3]);
+  if (scissor) glEnable(GL_SCISSOR_TEST);
+  return complete;
+}
+
+void OverlayCache::DrawTexture(const wxPoint2DDouble& offset) {
+  float x0 = wxRound(offset.m_x), y0 = wxRound(offset.m_y);
+  float x1 = x0 + m_TextureWidth, y1 = y0 + m_TextureHeight;
+  float coords[] = {x0, y0, x1, y0, x0, y1, x1, y1};
+  float uv[] = {0, 1, 1, 1, 0, 0, 1, 0};
+
+  GLint program = pi_texture_2D_shader_program;
+  glUseProgram(program);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  GLint pos = glGetAttribLocation(program, "aPos");
+  glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), coords);
+  glEnableVertexAttribArray(pos);
+  GLint tex = glGetAttribLocation(program, "aUV");
+  glVertexAttribPointer(tex, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), uv);
+  glEnableVertexAttribArray(tex);
+
+  /* the quad is in screen pixels, which MVMatrix takes */
+  float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+  glUniformMatrix4fv(glGetUniformLocation(program, "TransformMatrix"), 1,
+                     GL_FALSE, identity);
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, m_Texture);
+  glUniform1i(glGetUniformLocation(program, "uTex"), 0);
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glDisable(GL_BLEND);
+
+  glDisableVertexAttribArray(pos);
+  glDisableVertexAttribArray(tex);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glUseProgram(0);
+}
+#endif
@@ -0,0 +1,94 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#ifndef _OVERLAYCACHE_H_
+#define _OVERLAYCACHE_H_
+
+#include <functional>
+#include <vector>
+
+#include "pidc.h"
+
+class Sight;
+
+/* Keeps the drawn sights in an offscreen image larger than the viewport by
+   a margin on each side.  While the sights, scale, rotation and projection
+   stay the same, a pan only draws the image at an offset.  The image is
+   redrawn when any of those change or the pan runs past the margin.
+
+   On GLES2 the image is a framebuffer texture the sights are drawn into.
+   Desktop GL has no framebuffer objects without an extension loader, so
+   there, as on a wxDC, the sights are drawn into an alpha bitmap, which GL
+   then uploads to a texture. */
+class OverlayCache {
+public:
+  typedef std::function<void(piDC* dc, PlugIn_ViewPort& VP)> Painter;
+
+  OverlayCache();
+  ~OverlayCache();
+
+  /* draw the sights from the image, calling paint to redraw it first when
+     needed; paint draws in the coordinates of the viewport it is given.
+     Returns false if there is no offscreen image for this dc, in which case
+     the caller should draw directly.  cached is set when the image was drawn
+     without being redrawn. */
+  bool Render(piDC* dc, PlugIn_ViewPort& VP, const std::vector<Sight*>& sights,
+              double pix_per_mm, const Painter& paint, bool* cached = NULL);
+
+private:
+  /* what the image was drawn from: geometry and colour of each sight */
+  struct Key {
+    unsigned int geometry;
+    wxUint32 colour;
+    bool operator==(const Key& k) const {
+      return geometry == k.geometry && colour == k.colour;
+    }
+  };
+
+  bool Offset(PlugIn_ViewPort& VP, wxPoint2DDouble& offset);
+  void Enlarge(PlugIn_ViewPort& VP);
+
+  bool PaintBitmap(const Painter& paint);
+  void DrawBitmap(piDC* dc, const wxPoint2DDouble& offset);
+  bool PaintTexture(piDC* dc, PlugIn_ViewPort& VP, const Painter& paint);
+  void DrawTexture(const wxPoint2DDouble& offset);
+
+  bool m_bValid;
+  bool m_bGL;  // the image is the texture, else the bitmap
+  std::vector<Key> m_Keys;
+  double m_pix_per_mm;
+  PlugIn_ViewPort m_VP;  // viewport the image was drawn in, margin included
+  int m_MarginX, m_MarginY;
+
+  wxBitmap m_Bitmap;
+  GLuint m_Texture;
+  int m_TextureWidth, m_TextureHeight;
+#ifdef USE_ANDROID_GLES2
+  GLuint m_Framebuffer;
+#endif
+};
+
+#endif
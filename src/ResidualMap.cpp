@@ -0,0 +1,367 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ResidualMap.h"
+#include "SightWorkerPool.h"
+#include "celestial_navigation_pi.h"
+
+#ifdef USE_ANDROID_GLES2
+#include "pi_shaders.h"
+#endif
+
+/* most nodes across the grid */
+static const int s_MaxNodes = 512;
+/* nodes between those where the position is looked up */
+static const int s_Lattice = 8;
+/* rows in each task */
+static const int s_BandRows = 16;
+/* contours to span the grid before they are spread out */
+static const double s_Contours = 10;
+/* opacity of the colours and of the contours */
+static const int s_Alpha = 96, s_ContourAlpha = 192;
+
+ResidualMap::ResidualMap()
+    : m_pWorkers(NULL),
+      m_Width(0),
+      m_Height(0),
+      m_LatticeWidth(0),
+      m_Least(NAN),
+      m_Step(1),
+      m_bValid(false),
+      m_Spacing(1),
+      m_bBitmap(false),
+      m_bUploaded(false),
+      m_Texture(0),
+      m_TextureWidth(0),
+      m_TextureHeight(0) {}
+
+ResidualMap::~ResidualMap() {
+  delete m_pWorkers;
+  if (m_Texture) glDeleteTextures(1, &m_Texture);
+}
+
+void ResidualMap::Render(piDC* dc, PlugIn_ViewPort& VP,
+                         const std::vector<FixContribution>& contributions) {
+  if (contributions.empty() || VP.pix_width <= 0 || VP.pix_height <= 0)
+    return;
+
+  if (!Current(VP, contributions)) {
+    int k = (wxMax(VP.pix_width, VP.pix_height) + s_MaxNodes - 1) / s_MaxNodes;
+    PlugIn_ViewPort vp = VP;
+    Evaluate(contributions, (VP.pix_width + k - 1) / k,
+             (VP.pix_height + k - 1) / k,
+             [&](double x, double y, double& lat, double& lon) {
+               wxPoint p(wxRound((x + .5) * k), wxRound((y + .5) * k));
+               GetCanvasLLPix(&vp, p, &lat, &lon);
+             });
+    m_VP = VP;
+    m_Spacing = k;
+    m_bValid = true;
+  }
+
+  if (dc->GetDC())
+    DrawBitmap(dc);
+  else
+    DrawTexture();
+}
+
+bool ResidualMap::Current(PlugIn_ViewPort& VP,
+                          const std::vector<FixContribution>& contributions) {
+  return m_bValid && VP.m_projection_type == m_VP.m_projection_type &&
+         VP.clat == m_VP.clat && VP.clon == m_VP.clon &&
+         VP.view_scale_ppm == m_VP.view_scale_ppm &&
+         VP.rotation == m_VP.rotation && VP.skew == m_VP.skew &&
+         VP.pix_width == m_VP.pix_width && VP.pix_height == m_VP.pix_height &&
+         contributions.size() == m_Contributions.size() &&
+         !memcmp(&contributions[0], &m_Contributions[0],
+                 contributions.size() * sizeof(FixContribution));
+}
+
+void ResidualMap::Evaluate(const std::vector<FixContribution>& contributions,
+                           int width, int height, const Location& location) {
+  m_Contributions = contributions;
+  m_Width = width;
+  m_Height = height;
+  m_bBitmap = m_bUploaded = false;
+  m_Values.resize(width * height);
+  m_Pixels.resize(4 * width * height);
+
+  /* positions are only looked up on a coarser lattice, which always reaches
+     past the last node, and the lookups stay on this thread */
+  m_LatticeWidth = (width - 1) / s_Lattice + 2;
+  int latticeheight = (height - 1) / s_Lattice + 2;
+  m_Lattice.resize(3 * m_LatticeWidth * latticeheight);
+  for (int b = 0; b < latticeheight; b++)
+    for (int a = 0; a < m_LatticeWidth; a++) {
+      double lat, lon, *v = &m_Lattice[3 * (b * m_LatticeWidth + a)];
+      location(a * s_Lattice, b * s_Lattice, lat, lon);
+      if (!std::isfinite(lat) || !std::isfinite(lon)) {
+        v[0] = v[1] = v[2] = NAN;
+        continue;
+      }
+      v[0] = cos(d_to_r(lat)) * cos(d_to_r(lon));
+      v[1] = cos(d_to_r(lat)) * sin(d_to_r(lon));
+      v[2] = sin(d_to_r(lat));
+    }
+
+  /* the sum of w (g.p - sm)^2 over the contributions is the quadratic form
+     p.A p - 2 B.p + C, with the same sums the fix is solved from */
+  memset(m_A, 0, sizeof m_A);
+  memset(m_B, 0, sizeof m_B);
+  m_C = 0;
+  for (const FixContribution& c : contributions) {
+    double g[3] = {c.x, c.y, c.z};
+    for (int i = 0; i < 3; i++) {
+      for (int k = 0; k < 3; k++) m_A[i][k] += c.w * g[i] * g[k];
+      m_B[i] += c.w * c.sm * g[i];
+    }
+    m_C += c.w * c.sm * c.sm;
+  }
+
+  if (!m_pWorkers) m_pWorkers = new SightWorkerPool;
+
+  int bands = (height + s_BandRows - 1) / s_BandRows;
+  m_Scratch.resize(3 * (width + m_LatticeWidth) * bands);
+  m_BandLeast.assign(bands, INFINITY);
+  m_BandGreatest.assign(bands, -INFINITY);
+  for (int band = 0; band < bands; band++) {
+    int begin = band * s_BandRows, end = wxMin(begin + s_BandRows, height);
+    m_pWorkers->Submit([=] { EvaluateRows(band, begin, end); });
+  }
+  m_pWorkers->Wait();
+
+  /* contours are whole standard deviations from the least sum, spread to
+     powers of two of them when there would be more than s_Contours */
+  m_Least = *std::min_element(m_BandLeast.begin(), m_BandLeast.end());
+  double greatest =
+      *std::max_element(m_BandGreatest.begin(), m_BandGreatest.end());
+  m_Step = 1;
+  if (std::isfinite(m_Least))
+    while (sqrt(greatest - m_Least) / m_Step > s_Contours && m_Step < 1e12)
+      m_Step *= 2;
+
+  for (int band = 0; band < bands; band++) {
+    int begin = band * s_BandRows, end = wxMin(begin + s_BandRows, height);
+    m_pWorkers->Submit([=] { ColourRows(begin, end); });
+  }
+  m_pWorkers->Wait();
+}
+
+/* the rows from begin to end, band selects the scratch space.  Unit vectors
+   are interpolated between lattice nodes and normalized, then the sum is
+   the quadratic form, so the inner loops are plain arithmetic over arrays
+   the compiler can vectorize, and don't depend on the number of sights */
+void ResidualMap::EvaluateRows(int band, int begin, int end) {
+  int width = m_Width, lw = m_LatticeWidth;
+  double* lx = &m_Scratch[3 * (width + lw) * band];
+  double *ly = lx + lw, *lz = ly + lw;
+  double *x = lz + lw, *y = x + width, *z = y + width;
+  const double axx = m_A[0][0], ayy = m_A[1][1], azz = m_A[2][2];
+  const double axy = 2 * m_A[0][1], axz = 2 * m_A[0][2], ayz = 2 * m_A[1][2];
+  const double bx = -2 * m_B[0], by = -2 * m_B[1], bz = -2 * m_B[2];
+  const double cc = m_C;
+
+  double least = INFINITY, greatest = -INFINITY;
+  for (int j = begin; j < end; j++) {
+    /* between the lattice rows above and below, then along the row */
+    int b = j / s_Lattice;
+    double fy = (double)(j - b * s_Lattice) / s_Lattice;
+    const double* above = &m_Lattice[3 * b * lw];
+    const double* below = above + 3 * lw;
+    for (int a = 0; a < lw; a++) {
+      lx[a] = above[3 * a] + fy * (below[3 * a] - above[3 * a]);
+      ly[a] = above[3 * a + 1] + fy * (below[3 * a + 1] - above[3 * a + 1]);
+      lz[a] = above[3 * a + 2] + fy * (below[3 * a + 2] - above[3 * a + 2]);
+    }
+    for (int i = 0; i < width; i++) {
+      int a = i / s_Lattice;
+      double fx = (double)(i - a * s_Lattice) / s_Lattice;
+      double px = lx[a] + fx * (lx[a + 1] - lx[a]);
+      double py = ly[a] + fx * (ly[a + 1] - ly[a]);
+      double pz = lz[a] + fx * (lz[a + 1] - lz[a]);
+      double r = 1 / sqrt(px * px + py * py + pz * pz);
+      x[i] = px * r, y[i] = py * r, z[i] = pz * r;
+    }
+
+    double* v = &m_Values[j * width];
+    for (int i = 0; i < width; i++) {
+      double px = x[i], py = y[i], pz = z[i];
+      v[i] = px * (axx * px + axy * py + axz * pz + bx) +
+             py * (ayy * py + ayz * pz + by) + pz * (azz * pz + bz) + cc;
+    }
+
+    for (int i = 0; i < width; i++) {  // NaN off the globe compares false
+      if (v[i] < least) least = v[i];
+      if (v[i] > greatest) greatest = v[i];
+    }
+  }
+  m_BandLeast[band] = least;
+  m_BandGreatest[band] = greatest;
+}
+
+/* contour level of a sum, -1 off the globe */
+int ResidualMap::Level(double v) const {
+  if (std::isnan(v)) return -1;
+  return (int)wxMin(sqrt(wxMax(v - m_Least, 0.0)) / m_Step, 1e6);
+}
+
+/* blue at the least sum through cyan, green and yellow to red at
+   s_Contours contours out */
+static void Ramp(double u, unsigned char* rgb) {
+  static const unsigned char stops[5][3] = {
+      {0, 0, 255}, {0, 255, 255}, {0, 255, 0}, {255, 255, 0}, {255, 0, 0}};
+  u = wxMax(0.0, wxMin(u, 1.0)) * 4;
+  int i = wxMin((int)u, 3);
+  double f = u - i;
+  for (int k = 0; k < 3; k++)
+    rgb[k] = (unsigned char)(stops[i][k] + f * (stops[i + 1][k] - stops[i][k]));
+}
+
+/* colour the rows from begin to end, with a contour where the level changes
+   toward the next node to the right or below */
+void ResidualMap::ColourRows(int begin, int end) {
+  int width = m_Width;
+  for (int j = begin; j < end; j++)
+    for (int i = 0; i < width; i++) {
+      unsigned char* p = &m_Pixels[4 * (j * width + i)];
+      double v = m_Values[j * width + i];
+      if (std::isnan(v)) {
+        p[0] = p[1] = p[2] = p[3] = 0;
+        continue;
+      }
+
+      double t = sqrt(wxMax(v - m_Least, 0.0)) / m_Step;
+      int level = Level(v), right = -1, down = -1;
+      if (i + 1 < width) right = Level(m_Values[j * width + i + 1]);
+      if (j + 1 < m_Height) down = Level(m_Values[(j + 1) * width + i]);
+      bool contour =
+          (right >= 0 && right != level) || (down >= 0 && down != level);
+
+      if (contour) {
+        p[0] = p[1] = p[2] = 0;
+        p[3] = s_ContourAlpha;
+      } else {
+        Ramp(t / s_Contours, p);
+        p[3] = s_Alpha;
+      }
+    }
+}
+
+/* the grid stretched over the viewport */
+void ResidualMap::DrawBitmap(piDC* dc) {
+  if (!m_bBitmap) {
+    wxImage image(m_Width, m_Height, false);
+    image.InitAlpha();
+    unsigned char *rgb = image.GetData(), *alpha = image.GetAlpha();
+    for (int i = 0; i < m_Width * m_Height; i++) {
+      memcpy(rgb + 3 * i, &m_Pixels[4 * i], 3);
+      alpha[i] = m_Pixels[4 * i + 3];
+    }
+    image.Rescale(m_Width * m_Spacing, m_Height * m_Spacing,
+                  wxIMAGE_QUALITY_BILINEAR);
+    m_Bitmap = wxBitmap(image, 32);
+    m_bBitmap = true;
+  }
+  dc->GetDC()->DrawBitmap(m_Bitmap, 0, 0, true);
+}
+
+/* the grid as a texture filtered over the viewport */
+void ResidualMap::DrawTexture() {
+  if (!m_Texture) glGenTextures(1, &m_Texture);
+  glBindTexture(GL_TEXTURE_2D, m_Texture);
+  if (!m_bUploaded) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (m_Width != m_TextureWidth || m_Height != m_TextureHeight) {
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_Width, m_Height, 0, GL_RGBA,
+                   GL_UNSIGNED_BYTE, &m_Pixels[0]);
+      m_TextureWidth = m_Width;
+      m_TextureHeight = m_Height;
+    } else
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_Width, m_Height, GL_RGBA,
+                      GL_UNSIGNED_BYTE, &m_Pixels[0]);
+    m_bUploaded = true;
+  }
+
+  float x1 = m_Width * m_Spacing, y1 = m_Height * m_Spacing;
+  float coords[] = {0, 0, x1, 0, 0, y1, x1, y1};
+  float uv[] = {0, 0, 1, 0, 0, 1, 1, 1};
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+#ifdef USE_ANDROID_GLES2
+  GLint program = pi_texture_2D_shader_program;
+  glUseProgram(program);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  GLint pos = glGetAttribLocation(program, "aPos");
+  glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), coords);
+  glEnableVertexAttribArray(pos);
+  GLint tex = glGetAttribLocation(program, "aUV");
+  glVertexAttribPointer(tex, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), uv);
+  glEnableVertexAttribArray(tex);
+
+  /* the texture is laid out in screen pixels, which MVMatrix takes */
+  float identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+  glUniformMatrix4fv(glGetUniformLocation(program, "TransformMatrix"), 1,
+                     GL_FALSE, identity);
+
+  glActiveTexture(GL_TEXTURE0);
+  glUniform1i(glGetUniformLocation(program, "uTex"), 0);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+  glDisableVertexAttribArray(pos);
+  glDisableVertexAttribArray(tex);
+  glUseProgram(0);
+#else
+  glEnable(GL_TEXTURE_2D);
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glVertexPointer(2, GL_FLOAT, 0, coords);
+  glTexCoordPointer(2, GL_FLOAT, 0, uv);
+  glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+  glDisable(GL_TEXTURE_2D);
+#endif
+  glDisable(GL_BLEND);
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
@@ -0,0 +1,103 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#ifndef _RESIDUALMAP_H_
+#define _RESIDUALMAP_H_
+
+#include <functional>
+#include <vector>
+
+#include "pidc.h"
+#include "FixEngine.h"
+
+class SightWorkerPool;
+
+/* The weighted sum of squared residuals of the fix's sights over the chart,
+   drawn as a colour map with contours at whole standard deviations from its
+   least value, or at powers of two of them when there would be too many.
+   It is evaluated on a grid of at most 512 nodes across the viewport, in
+   bands of rows spread over worker threads, and kept until the sights or
+   the viewport change. */
+class ResidualMap {
+public:
+  /* latitude and longitude at node x, y of the grid, NaN off the globe */
+  typedef std::function<void(double x, double y, double& lat, double& lon)>
+      Location;
+
+  ResidualMap();
+  ~ResidualMap();
+
+  /* draw the map of the contributions over the viewport, evaluating it
+     again first if they or the viewport changed */
+  void Render(piDC* dc, PlugIn_ViewPort& VP,
+              const std::vector<FixContribution>& contributions);
+
+  /* evaluate and colour the map on a width by height grid.  location is
+     only asked every few nodes, the positions between are interpolated */
+  void Evaluate(const std::vector<FixContribution>& contributions, int width,
+                int height, const Location& location);
+
+  /* by rows, the weighted sum of squares at each node and its colour as
+     rgba, and the least of the sums */
+  const std::vector<double>& Values() const { return m_Values; }
+  const std::vector<unsigned char>& Pixels() const { return m_Pixels; }
+  double Least() const { return m_Least; }
+
+private:
+  bool Current(PlugIn_ViewPort& VP,
+               const std::vector<FixContribution>& contributions);
+  void EvaluateRows(int band, int begin, int end);
+  int Level(double v) const;
+  void ColourRows(int begin, int end);
+  void DrawBitmap(piDC* dc);
+  void DrawTexture();
+
+  SightWorkerPool* m_pWorkers;  // started when first needed
+
+  std::vector<FixContribution> m_Contributions;
+  double m_A[3][3], m_B[3], m_C;  // weighted sums of g gt, sm g and sm^2
+  int m_Width, m_Height;
+  int m_LatticeWidth;
+  std::vector<double> m_Lattice;  // unit vectors at every few nodes
+  std::vector<double> m_Scratch;  // unit vectors of a row for each band
+  std::vector<double> m_BandLeast, m_BandGreatest;
+  std::vector<double> m_Values;
+  std::vector<unsigned char> m_Pixels;
+  double m_Least, m_Step;  // sum at the contour origin, sigmas between them
+
+  bool m_bValid;
+  PlugIn_ViewPort m_VP;  // evaluated for
+  int m_Spacing;         // screen pixels between nodes
+
+  bool m_bBitmap;  // m_Bitmap is up to date with m_Pixels
+  wxBitmap m_Bitmap;
+
+  bool m_bUploaded;  // m_Texture is up to date with m_Pixels
+  GLuint m_Texture;
+  int m_TextureWidth, m_TextureHeight;
+};
+
+#endif  // _RESIDUALMAP_H_
@@ -36,8 +36,8 @@
 #include <time.h>
 
 #include <wx/wx.h>
-#include <wx/progdlg.h>
 #include <wx/listimpl.cpp>
+#include <wx/thread.h>
 #include <wx/fileconf.h>
 
 #include "ocpn_plugin.h"
@@ -59,12 +59,73 @@ double resolve_heading_positive(double heading) {
   return heading >= 0 ? heading : 360 + heading;
 }
 
+/* mercator latitude in degrees, clamped short of the poles */
+double MercatorY(double lat) {
+  lat = wxMax(-89.0, wxMin(89.0, lat));
+  return r_to_d(asinh(tan(d_to_r(lat))));
+}
+
 //-----------------------------------------------------------------------------
 //          Sight Implementation
 //-----------------------------------------------------------------------------
 
+SightExtent::SightExtent()
+    : m_LatMin(INFINITY),
+      m_LatMax(-INFINITY),
+      m_LonMin(0),
+      m_LonSpan(0),
+      m_Lon180Min(INFINITY),
+      m_Lon180Max(-INFINITY),
+      m_Lon360Min(INFINITY),
+      m_Lon360Max(-INFINITY) {}
+
+void SightExtent::Add(double lat, double lon) {
+  m_LatMin = wxMin(m_LatMin, lat);
+  m_LatMax = wxMax(m_LatMax, lat);
+
+  lon = resolve_heading(lon);
+  m_Lon180Min = wxMin(m_Lon180Min, lon);
+  m_Lon180Max = wxMax(m_Lon180Max, lon);
+
+  lon = resolve_heading_positive(lon);
+  m_Lon360Min = wxMin(m_Lon360Min, lon);
+  m_Lon360Max = wxMax(m_Lon360Max, lon);
+
+  /* use whichever range is narrower, so boxes crossing the antimeridian are
+     measured in 0..360 */
+  if (m_Lon180Max - m_Lon180Min <= m_Lon360Max - m_Lon360Min) {
+    m_LonMin = m_Lon180Min;
+    m_LonSpan = m_Lon180Max - m_Lon180Min;
+  } else {
+    m_LonMin = m_Lon360Min;
+    m_LonSpan = m_Lon360Max - m_Lon360Min;
+  }
+
+  /* the points may go all the way around (or around a pole) */
+  if (m_LonSpan > 180) {
+    m_LonMin = -180;
+    m_LonSpan = 360;
+  }
+}
+
+bool SightExtent::Intersects(const PlugIn_ViewPort& VP) const {
+  if (!VP.bValid) return true;
+
+  if (m_LatMin > VP.lat_max || m_LatMax < VP.lat_min) return false;
+
+  double vpspan = VP.lon_max - VP.lon_min;
+  if (vpspan < 0) vpspan += 360;
+  if (m_LonSpan >= 360 || vpspan >= 360) return true;
+
+  return resolve_heading_positive(VP.lon_min - m_LonMin) <= m_LonSpan ||
+         resolve_heading_positive(m_LonMin - VP.lon_min) <= vpspan;
+}
+
 int Sight::s_lastsightcolor;
 
+/* source of Sight::m_GeometryId, polygons are rebuilt on worker threads */
+static std::atomic<unsigned int> s_GeometryIds(0);
+
 Sight::Sight(Type type, wxString body, BodyLimb bodylimb, wxDateTime datetime,
              double timecertainty, double measurement,
              double measurementcertainty)
@@ -83,11 +144,16 @@ Sight::Sight(Type type, wxString body, BodyLimb bodylimb, wxDateTime datetime,
       m_ShiftNm(0),
       m_ShiftBearing(0),
       m_bMagneticShiftBearing(true),
+      m_MeasurementScale(1),
+      m_RefractionCorrection(0),
       m_bMagneticNorth(true),
       m_DRLat(0),
       m_DRLon(0),
       m_DRBoatPosition(true),
-      m_DRMagneticAzimuth(false) {
+      m_DRMagneticAzimuth(false),
+      m_RebuildTicket(0),
+      m_GeometryId(0),
+      m_bProjected(false) {
   wxFileConfig* pConf = GetOCPNConfigObject();
   pConf->SetPath(_T("/PlugIns/CelestialNavigation"));
 
@@ -154,6 +220,16 @@ Sight::Sight(Type type, wxString body, BodyLimb bodylimb, wxDateTime datetime,
 
 Sight::~Sight() {}
 
+SightPoints::~SightPoints() {
+  for (wxRealPointList* polygon : polygons) {
+    for (wxRealPointList::iterator it = polygon->begin(); it != polygon->end();
+         it++)
+      delete *it;
+    delete polygon;
+  }
+  for (wxRealPoint* point : lines) delete point;
+}
+
 void Sight::SetVisible(bool visible) { m_bVisible = visible; }
 void Sight::SetSelected(bool selected) { m_bSelected = selected; }
 
@@ -170,13 +246,29 @@ using namespace astrolabe::sun;
 using namespace astrolabe::vsop87d;
 using astrolabe::util::ecl_to_equ;
 
+/* point astrolabe at its data and load the planetary terms, returning why
+   it failed or an empty string.  This only runs once, from a static
+   initializer so that it is safe when sights are being computed on several
+   threads at the same time.  A failed load is final, as astrolabe would
+   otherwise read the terms again from whichever threads come next */
+static std::string LoadVSOP87d() {
+  astrolabe::globals::vsop87d_text_path = celestial_navigation_pi_DataDir();
+  astrolabe::globals::vsop87d_text_path.append("/data/");
+  astrolabe::globals::vsop87d_text_path.append("vsop87d.txt");
+
+  try {
+    VSOP87d vsop;
+  } catch (Error const& e) {
+    return e.what();
+  }
+  return std::string();
+}
+
 /* calculate what position the body for this sight is directly over at a given
  * time */
 void Sight::BodyLocation(wxDateTime time, double* lat, double* lon,
                          double* ghaast, double* rad, double* dist) {
-  astrolabe::globals::vsop87d_text_path = celestial_navigation_pi_DataDir();
-  astrolabe::globals::vsop87d_text_path.append("/data/");
-  astrolabe::globals::vsop87d_text_path.append("vsop87d.txt");
+  static const std::string vsop87d_error = LoadVSOP87d();
 
   time.MakeFromUTC();
   double jdu = time.GetJulianDayNumber();
@@ -192,11 +284,12 @@ void Sight::BodyLocation(wxDateTime time, double* lat, double* lon,
   const double eps = obliquity(jdd) + nut_in_obl(jdd);
 
   try {
+    if (!vsop87d_error.empty()) throw Error(vsop87d_error);
     Sun sun;
     sun.dimension3(jdd, l, b, r);
   } catch (Error const& e) {
     static bool showonce = false;
-    if (!showonce) {
+    if (!showonce && wxThread::IsMain()) {
       wxString err;
       const char* what = e.what();
       while (*what) err += *what++;
@@ -368,125 +461,180 @@ std::list<wxRealPoint> Sight::GetPoints() {
   return points;
 }
 
-/* Combine two lists of points by appending p2 to p1 */
-wxRealPointList* Sight::MergePoints(wxRealPointList* p1, wxRealPointList* p2) {
-  /* combine lists of points */
-  wxRealPointList* p = new wxRealPointList;
-  wxRealPointList::iterator it;
-  for (it = p1->begin(); it != p1->end(); ++it)
-    p->Append(new wxRealPoint(**it));
-  for (it = p2->begin(); it != p2->end(); ++it)
-    p->Append(new wxRealPoint(**it));
-  return p;
-}
-
-/* give the angle between two points from 0 to 2 PI */
-double Sight::CalcAngle(wxRealPoint p1, wxRealPoint p2) {
-  /* rectangular coords */
-  double phi = atan2(p1.y - p2.y, p1.x - p2.x);
-  if (phi < 0) phi += 2 * pi;
-  return phi;
+/* which 45 degree slot of longitude a point is in */
+static int LongitudeSlot(const wxRealPoint& p) {
+  return (int)floor((resolve_heading(p.y) + 180) / 45);
 }
 
-/* take a list of points, and return a list of points
-   which form a convex polygon which encompasses all the points with vertices at
-   points. */
-wxRealPointList* Sight::ReduceToConvexPolygon(wxRealPointList* points) {
-  wxRealPointList* polygon = new wxRealPointList;
-  wxRealPointList::iterator it, min;
-  /* get min y point to start out at */
-  for (min = it = points->begin(); it != points->end(); ++it)
-    if ((*it)->y < (*min)->y) min = it;
-
-  double theta = 0;
-  while (!points->IsEmpty()) {
-    polygon->Append(*min);
-    points->DeleteObject(*min);
-
-    /* delete duplicates (optimization) */
-    it = points->begin();
-    while (it != points->end())
-      if (**it == *polygon->back()) {
-        wxRealPointList::iterator l = it;
-        ++it;
-        points->DeleteObject(*l);
-      } else
-        ++it;
-
-    double minphi = 2 * pi, maxdist = 0;
-    for (min = it = points->begin(); it != points->end(); ++it) {
-      double phi = CalcAngle(**it, *polygon->back());
-      double dist =
-          hypot((*it)->x - polygon->back()->x, (*it)->y - polygon->back()->y);
-      if (maxdist == 0) maxdist = dist;
-
-      if ((phi >= theta && phi < minphi) || (phi == minphi && dist > maxdist)) {
-        min = it;
-        minphi = phi;
-        maxdist = dist;
-      }
+/* Add the area between two sides of a line of position, given as matching
+   points along each side.  Rather than many small polygons, the band is a
+   few triangle strips that are each one fill call with no tessellation.  It
+   is cut where it crosses a multiple of 45 degrees of longitude to keep each
+   fill call small.  The cuts do not follow the chart center, so a piece may
+   still cross the meridian opposite it, and only its triangles across that
+   meridian are left out when drawn. */
+void Sight::BuildBand(const std::vector<wxRealPoint>& side1,
+                      const std::vector<wxRealPoint>& side2) {
+  size_t n = wxMin(side1.size(), side2.size());
+  size_t start = 0;
+  for (size_t end = 1; end < n; end++) {
+    if (end < n - 1 &&
+        LongitudeSlot(side1[end - 1]) == LongitudeSlot(side1[end]))
+      continue;
+
+    /* a triangle strip alternating sides, pieces share their end edges */
+    wxRealPointList* polygon = new wxRealPointList;
+    for (size_t i = start; i <= end; i++) {
+      polygon->Append(new wxRealPoint(side1[i]));
+      polygon->Append(new wxRealPoint(side2[i]));
     }
+    polygons.push_back(polygon);
 
-    if (polygon->size() > 1 &&
-        CalcAngle(*polygon->front(), *polygon->back()) < minphi)
-      break;
-
-    theta = minphi;
+    start = end;
   }
-
-  return polygon;
 }
 
-/* Draw a polygon or polyline (specified in lat/lon coords) to dc given a list
- * of points */
-void Sight::DrawPolygon(PlugIn_ViewPort& VP, wxRealPointList& area, bool poly) {
-  int n = area.size();
-  wxPoint* ppoints = new wxPoint[n];
-  bool rear1 = false, rear2 = false;
-  wxRealPointList::iterator it = area.begin();
+/* project an area (specified in lat/lon coords) to screen coordinates */
+void Sight::ProjectArea(PlugIn_ViewPort& VP,
+                        const std::vector<wxRealPoint>& area,
+                        ProjectedArea& projected) {
+  projected.points.resize(area.size());
 
-  double minx = 1000;
-  double maxx = -1000;
-  double miny = 1000;
-  double maxy = -1000;
+  for (size_t i = 0; i < area.size(); i++)
+    GetCanvasPixLL(&VP, &projected.points[i], area[i].x, area[i].y);
+  projected.projected = true;
+}
+
+/* which side of the meridian opposite lon a point is just past, 0 if it is
+   more than 90 degrees from it */
+static int RearSide(const wxRealPoint& p, double lon) {
+  lon = resolve_heading_positive(p.y - lon);
+  if (lon > 90 && lon <= 180) return 1;
+  if (lon > 180 && lon < 270) return 2;
+  return 0;
+}
 
-  for (int i = 0; i < n && it != area.end(); i++, it++) {
-    wxPoint r;
+/* flag areas crossing opposite from center longitude, which are drawn without
+   the parts across it.  Returns false if a vertex moved across that longitude
+   since the areas were projected, as it is then placed on the other side of
+   the chart */
+bool Sight::UpdateRear(PlugIn_ViewPort& VP) {
+  double dlon = resolve_heading(VP.clon - m_ProjectedVP.clon);
+  bool wrapped = false, rear1 = false, rear2 = false;
+  m_RearLon = VP.clon;
+
+  auto vertex = [&](const wxRealPoint* p) {
+    double lon = p->y - VP.clon;
+    double projectedlon = resolve_heading(p->y - m_ProjectedVP.clon);
+    if (fabs(projectedlon - dlon - resolve_heading(lon)) > 180) wrapped = true;
+
+    int side = RearSide(*p, VP.clon);
+    if (side == 1) rear1 = true;
+    if (side == 2) rear2 = true;
+  };
+
+  std::vector<ProjectedArea>::iterator pit = m_Projected.begin();
+  for (std::list<wxRealPointList*>::iterator it = polygons.begin();
+       it != polygons.end(); ++it, ++pit) {
+    rear1 = rear2 = false;
+    for (wxRealPointList::iterator it2 = (*it)->begin(); it2 != (*it)->end();
+         it2++)
+      vertex(*it2);
+    pit->rear = rear1 && rear2;
+  }
 
-    /* don't draw areas crossing opposite from center longitude */
-    double lon = (*it)->y - VP.clon;
-    lon = resolve_heading_positive(lon);
+  wxRealPointList::iterator it = lines.begin();
+  for (size_t band = 0; band < m_LineBands.size(); band++, ++pit) {
+    rear1 = rear2 = false;
+    for (size_t i = m_LineBands[band]; i < LineBandEnd(band); i++, it++)
+      vertex(*it);
+    pit->rear = rear1 && rear2;
+  }
 
-    if (lon > 90 && lon <= 180) rear1 = true;
-    if (lon > 180 && lon < 270) rear2 = true;
+  return !wrapped;
+}
 
-    (*it)->y = resolve_heading((*it)->y);
+/* bring the cached screen coordinates up to date for VP.  Reprojecting every
+   vertex is only needed when the projection changes, panning a mercator chart
+   moves everything on screen by the same amount */
+void Sight::Project(PlugIn_ViewPort& VP) {
+  bool panned = m_bProjected &&
+                VP.view_scale_ppm == m_ProjectedVP.view_scale_ppm &&
+                VP.rotation == m_ProjectedVP.rotation &&
+                VP.skew == m_ProjectedVP.skew &&
+                VP.pix_width == m_ProjectedVP.pix_width &&
+                VP.pix_height == m_ProjectedVP.pix_height &&
+                VP.m_projection_type == m_ProjectedVP.m_projection_type;
+
+  if (panned && VP.clat == m_DrawnCenter.x && VP.clon == m_DrawnCenter.y)
+    return;
 
-    minx = wxMin(minx, (*it)->x);
-    miny = wxMin(miny, (*it)->y);
-    maxx = wxMax(maxx, (*it)->x);
-    maxy = wxMax(maxy, (*it)->y);
+  m_DrawnCenter = wxRealPoint(VP.clat, VP.clon);
+  if (panned && VP.m_projection_type == PI_PROJECTION_MERCATOR &&
+      UpdateRear(VP)) {
+    wxPoint center;
+    GetCanvasPixLL(&VP, &center, m_ProjectedVP.clat, m_ProjectedVP.clon);
+    m_ProjectedShift = center - m_ProjectedCenter;
+    return;
+  }
 
-    GetCanvasPixLL(&VP, &r, (*it)->x, (*it)->y);
+  /* areas are projected when first drawn, which may be after some panning,
+     so they are always projected at m_ProjectedVP */
+  m_ProjectedVP = VP;
+  m_Projected.resize(polygons.size() + m_LineBands.size());
+  for (size_t i = 0; i < m_Projected.size(); i++)
+    m_Projected[i].projected = false;
+  UpdateRear(VP);
+
+  GetCanvasPixLL(&VP, &m_ProjectedCenter, VP.clat, VP.clon);
+  m_ProjectedShift = wxPoint(0, 0);
+  m_bProjected = true;
+}
 
-    ppoints[i] = r;
+/* Draw a polygon or polyline to dc given a list of points and their cached
+ * projection */
+void Sight::DrawPolygon(const std::vector<wxRealPoint>& area,
+                        ProjectedArea& projected, bool poly) {
+  if (!projected.projected) ProjectArea(m_ProjectedVP, area, projected);
+
+  int n = projected.points.size();
+  if (n == 0) return;
+
+  wxPoint* ppoints = &projected.points[0];
+  if (m_ProjectedShift != wxPoint(0, 0)) {
+    m_ShiftedPoints.resize(n);
+    for (int i = 0; i < n; i++)
+      m_ShiftedPoints[i] = projected.points[i] + m_ProjectedShift;
+    ppoints = &m_ShiftedPoints[0];
   }
 
-  if (!(rear1 && rear2)) {
+  auto draw = [&](int start, int count) {
     if (poly) {
-      m_dc->DrawPolygon(n, ppoints);
+      if (count >= 3) m_dc->DrawTriangleStrip(count, ppoints + start);
     } else {
 #if USE_ANDROID_GLES2
-      for (int i = 0; i < n - 1; i++)
+      for (int i = start; i < start + count - 1; i++)
         m_dc->DrawLine(ppoints[i].x, ppoints[i].y, ppoints[i + 1].x,
                        ppoints[i + 1].y);
 #else
-      m_dc->DrawLines(n, ppoints);
+      if (count >= 2) m_dc->DrawLines(count, ppoints + start);
 #endif
     }
+  };
+
+  /* the vertices of a triangle (or segment) across the rear meridian are
+     projected to opposite edges of the chart, so a rear area is drawn in
+     runs leaving those out */
+  int step = poly ? 3 : 2, start = 0;
+  for (int i = 0; projected.rear && i + step <= n; i++) {
+    int sides = 0;
+    for (int j = i; j < i + step; j++)
+      sides |= 1 << RearSide(area[j], m_RearLon);
+    if ((sides & 6) != 6) continue;
+    draw(start, i + step - 1 - start);
+    start = i + 1;
   }
-
-  delete[] ppoints;
+  draw(start, n - start);
 }
 
 /* Compute trace areas for one dimension, given center certainty, and constant
@@ -497,22 +645,147 @@ double Sight::ComputeStepSize(double certainty, double stepsize, double min,
 }
 
 /* render the area of position for this sight */
-void Sight::Render(piDC* dc, PlugIn_ViewPort& VP, double pix_per_mm) {
+void Sight::Render(piDC* dc, PlugIn_ViewPort& VP, double pix_per_mm,
+                   SightRenderStats* stats) {
   if (!m_bVisible) return;
 
+  /* lunar sights and sights not yet built have no extents */
+  bool cull = m_Extents.size() == polygons.size() + 1;
+  if (cull && !m_Extent.Intersects(VP)) {
+    if (stats) stats->sightsculled++;
+    return;
+  }
+  if (stats) stats->sights++;
+
   m_dc = dc;
 
   dc->SetPen(wxPen(m_Colour, 0, wxPENSTYLE_TRANSPARENT));
   dc->SetBrush(wxBrush(m_Colour));
 
-  std::list<wxRealPointList*>::iterator it = polygons.begin();
-  while (it != polygons.end()) {
-    DrawPolygon(VP, **it, true);
-    ++it;
+  /* the band only changes with the scale, which also reprojects */
+  Project(VP);
+  const Geometry& geometry = Simplified(ZoomBand(VP));
+
+  for (size_t i = 0; i < polygons.size(); i++) {
+    if (cull && !m_Extents[i].Intersects(VP)) {
+      if (stats) stats->polygonsculled++;
+      continue;
+    }
+    if (stats) stats->polygons++;
+    DrawPolygon(geometry[i], m_Projected[i], true);
   }
 
+  if (cull && !m_Extents.back().Intersects(VP)) return;
+
   dc->SetPen(wxPen(m_Colour, (int)(0.5 * pix_per_mm)));
-  DrawPolygon(VP, lines, false);
+  for (size_t i = polygons.size(); i < geometry.size(); i++)
+    DrawPolygon(geometry[i], m_Projected[i], false);
+}
+
+/* simplified geometry stays within this many pixels of the full geometry */
+static const double s_SimplifyPixels = 1;
+
+/* zoom bands kept simplified before starting over */
+static const size_t s_SimplifiedBands = 4;
+
+int Sight::ZoomBand(const PlugIn_ViewPort& VP) {
+  if (!(VP.view_scale_ppm > 0)) return 64;  // full resolution
+  return (int)floor(log2(VP.view_scale_ppm));
+}
+
+/* distance from p to the segment from a to b */
+static double SegmentDistance(const wxRealPoint& p, const wxRealPoint& a,
+                              const wxRealPoint& b) {
+  double dx = b.x - a.x, dy = b.y - a.y;
+  double l = dx * dx + dy * dy;
+  double t = l > 0 ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / l : 0;
+  t = wxMax(0.0, wxMin(1.0, t));
+  return hypot(p.x - a.x - t * dx, p.y - a.y - t * dy);
+}
+
+std::vector<wxRealPoint> Sight::Simplify(const std::vector<wxRealPoint>& points,
+                                         double tolerance, bool strip) {
+  int stride = strip ? 2 : 1;
+  int n = points.size() / stride;
+  if (n < 3) return points;
+
+  /* x is longitude unwrapped along each side and y mercator latitude, which
+     is screen space up to scale on a mercator chart */
+  std::vector<wxRealPoint> xy(points.size());
+  for (size_t i = 0; i < points.size(); i++) {
+    xy[i].y = MercatorY(points[i].x);
+    if (i < (size_t)stride)
+      xy[i].x = points[i].y;
+    else
+      xy[i].x = xy[i - stride].x +
+                resolve_heading(points[i].y - points[i - stride].y);
+  }
+
+  std::vector<bool> keep(n, false);
+  keep[0] = keep[n - 1] = true;
+  std::vector<std::pair<int, int> > spans(1, std::make_pair(0, n - 1));
+  while (!spans.empty()) {
+    int a = spans.back().first, b = spans.back().second;
+    spans.pop_back();
+
+    double worst = tolerance;
+    int split = -1;
+    for (int i = a + 1; i < b; i++) {
+      double d = 0;
+      for (int s = 0; s < stride; s++)
+        d = wxMax(d, SegmentDistance(xy[i * stride + s], xy[a * stride + s],
+                                     xy[b * stride + s]));
+      if (d > worst) {
+        worst = d;
+        split = i;
+      }
+    }
+    if (split < 0) continue;
+
+    keep[split] = true;
+    spans.push_back(std::make_pair(a, split));
+    spans.push_back(std::make_pair(split, b));
+  }
+
+  std::vector<wxRealPoint> simplified;
+  for (int i = 0; i < n; i++)
+    if (keep[i])
+      for (int s = 0; s < stride; s++)
+        simplified.push_back(points[i * stride + s]);
+  for (size_t i = n * stride; i < points.size(); i++)
+    simplified.push_back(points[i]);
+  return simplified;
+}
+
+const Sight::Geometry& Sight::Simplified(int band) {
+  std::map<int, Geometry>::iterator it = m_Simplified.find(band);
+  if (it != m_Simplified.end()) return it->second;
+  if (m_Simplified.size() >= s_SimplifiedBands) m_Simplified.clear();
+
+  /* a band spans scales up to twice its lowest, the tolerance is taken at
+     the top so it holds across the band.  A degree of longitude is at most
+     60 nm on screen at the chart center scale */
+  double tolerance = s_SimplifyPixels / (ldexp(1.0, band + 1) * 60 * 1852);
+
+  Geometry& geometry = m_Simplified[band];
+  std::vector<wxRealPoint> points;
+  for (std::list<wxRealPointList*>::iterator it = polygons.begin();
+       it != polygons.end(); it++) {
+    points.clear();
+    for (wxRealPointList::iterator it2 = (*it)->begin(); it2 != (*it)->end();
+         it2++)
+      points.push_back(**it2);
+    geometry.push_back(Simplify(points, tolerance, true));
+  }
+
+  wxRealPointList::iterator it2 = lines.begin();
+  for (size_t band = 0; band < m_LineBands.size(); band++) {
+    points.clear();
+    for (size_t i = m_LineBands[band]; i < LineBandEnd(band); i++, it2++)
+      points.push_back(**it2);
+    geometry.push_back(Simplify(points, tolerance, false));
+  }
+  return geometry;
 }
 
 void Sight::Recompute(int clock_offset) {
@@ -537,39 +810,160 @@ void Sight::Recompute(int clock_offset) {
   }
 }
 
-void Sight::RebuildPolygons() {
+void Sight::RebuildPolygons(double step, const std::atomic<bool>* cancel) {
+  m_RebuildTicket = 0;
+
+  /* variation depends on the sight time, so start with an empty grid */
+  m_VariationGrid.clear();
+  m_bProjected = false;
+  m_Extents.clear();
+  m_Simplified.clear();
+  m_BandCenters.clear();
+  m_LineBands.clear();
+
   switch (m_Type) {
     case ALTITUDE:
-      RebuildPolygonsAltitude();
+      RebuildPolygonsAltitude(step, cancel);
       break;
     case AZIMUTH:
-      RebuildPolygonsAzimuth();
+      RebuildPolygonsAzimuth(step, cancel);
       break;
     case LUNAR:
       return;  // lunar has no polygons
   }
 
+  /* the last rebuild's points go with the last copy of the sight using
+     them, these with this one, even if it was cancelled part way */
+  m_Points = std::make_shared<SightPoints>();
+  m_Points->polygons = polygons;
+  for (wxRealPointList::iterator it = lines.begin(); it != lines.end(); it++)
+    m_Points->lines.push_back(*it);
+
+  if (cancel && *cancel) return;
+
   /* now shift the vertices as needed */
+  if (m_ShiftNm)
+    for (std::list<wxRealPointList*>::iterator it = polygons.begin();
+         it != polygons.end(); it++) {
+      wxRealPointList* area = *it;
+      for (wxRealPointList::iterator it2 = area->begin(); it2 != area->end();
+           it2++) {
+        wxRealPoint* p = *it2;
+        double lat = p->x, lon = p->y;
+
+        double localbearing = m_ShiftBearing;
+        if (m_bMagneticShiftBearing) {
+          lon = resolve_heading(lon);
+          localbearing += MagneticVariation(lat, lon);
+        }
+        double localaltitude = 90 - m_ShiftNm / 60;
+        *p = DistancePoint(localaltitude, localbearing, lat, lon);
+      }
+    }
+
+  /* keep longitudes in range once here rather than on every draw */
   for (std::list<wxRealPointList*>::iterator it = polygons.begin();
-       it != polygons.end(); it++) {
-    wxRealPointList* area = *it;
-    for (wxRealPointList::iterator it2 = area->begin(); it2 != area->end();
+       it != polygons.end(); it++)
+    for (wxRealPointList::iterator it2 = (*it)->begin(); it2 != (*it)->end();
+         it2++)
+      (*it2)->y = resolve_heading((*it2)->y);
+  for (wxRealPointList::iterator it = lines.begin(); it != lines.end(); it++)
+    (*it)->y = resolve_heading((*it)->y);
+
+  ComputeExtents();
+  m_GeometryId = ++s_GeometryIds;
+
+  m_bCalculated = true;
+}
+
+void Sight::GetGeometry(SightGeometry& geometry) const {
+  geometry.points = m_Points;
+  geometry.polygons = polygons;
+  geometry.lines = lines;
+  geometry.linebands = m_LineBands;
+  geometry.bandcenters = m_BandCenters;
+  geometry.extents = m_Extents;
+  geometry.extent = m_Extent;
+  geometry.id = m_GeometryId;
+  geometry.calculated = m_bCalculated;
+}
+
+void Sight::SetGeometry(const SightGeometry& geometry) {
+  m_Points = geometry.points;
+  polygons = geometry.polygons;
+  lines = geometry.lines;
+  m_LineBands = geometry.linebands;
+  m_BandCenters = geometry.bandcenters;
+  m_Extents = geometry.extents;
+  m_Extent = geometry.extent;
+  m_GeometryId = geometry.id;
+  m_bCalculated = geometry.calculated;
+
+  m_bProjected = false;
+  m_Simplified.clear();
+}
+
+/* bounding boxes used to skip what is outside the viewport when rendering */
+void Sight::ComputeExtents() {
+  m_Extents.assign(polygons.size() + 1, SightExtent());
+  m_Extent = SightExtent();
+
+  std::vector<SightExtent>::iterator eit = m_Extents.begin();
+  for (std::list<wxRealPointList*>::iterator it = polygons.begin();
+       it != polygons.end(); it++, eit++)
+    for (wxRealPointList::iterator it2 = (*it)->begin(); it2 != (*it)->end();
          it2++) {
-      wxRealPoint* p = *it2;
-      double lat = p->x, lon = p->y;
-
-      double localbearing = m_ShiftBearing;
-      if (m_bMagneticShiftBearing) {
-        lon = resolve_heading(lon);
-        localbearing += celestial_navigation_pi_GetWMM(lat, lon, m_EyeHeight,
-                                                       m_CorrectedDateTime);
-      }
-      double localaltitude = 90 - m_ShiftNm / 60;
-      *p = DistancePoint(localaltitude, localbearing, lat, lon);
+      eit->Add((*it2)->x, (*it2)->y);
+      m_Extent.Add((*it2)->x, (*it2)->y);
     }
+
+  for (wxRealPointList::iterator it = lines.begin(); it != lines.end(); it++) {
+    eit->Add((*it)->x, (*it)->y);
+    m_Extent.Add((*it)->x, (*it)->y);
   }
+}
 
-  m_bCalculated = true;
+/* spacing in degrees of the magnetic variation grid */
+static const int s_VariationGridStep = 2;
+static const int s_VariationGridRows = 180 / s_VariationGridStep + 1;
+static const int s_VariationGridColumns = 360 / s_VariationGridStep;
+
+/* Magnetic variation at a position, interpolated from the grid nodes around
+   it.  Each node queries the magnetic model the first time it is needed so a
+   sight only pays for the region its polygons actually cover.  The model has
+   no answer at the poles, those nodes are left out of the interpolation. */
+double Sight::MagneticVariation(double lat, double lon) {
+  if (m_VariationGrid.empty())
+    m_VariationGrid.resize(s_VariationGridRows * s_VariationGridColumns,
+                           INFINITY);
+
+  double fi = (wxMax(-90.0, wxMin(90.0, lat)) + 90) / s_VariationGridStep;
+  double fj = resolve_heading_positive(lon) / s_VariationGridStep;
+  int i0 = floor(fi), j0 = floor(fj);
+  double u = fi - i0, v = fj - j0;
+
+  double sum = 0, weight = 0;
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 2; j++) {
+      double w = (i ? u : 1 - u) * (j ? v : 1 - v);
+      if (w == 0) continue;
+
+      int row = wxMin(i0 + i, s_VariationGridRows - 1);
+      int column = (j0 + j) % s_VariationGridColumns;
+      double& variation =
+          m_VariationGrid[row * s_VariationGridColumns + column];
+      if (isinf(variation))
+        variation = celestial_navigation_pi_GetWMM(
+            row * s_VariationGridStep - 90,
+            resolve_heading(column * s_VariationGridStep), m_EyeHeight,
+            m_CorrectedDateTime);
+
+      if (isnan(variation)) continue;
+      sum += w * variation;
+      weight += w;
+    }
+
+  return weight > 0 ? sum / weight : NAN;
 }
 
 wxString Sight::Alminac(wxDateTime time, double lat, double lon, double ghaast,
@@ -610,6 +1004,13 @@ HP = %.4f'\n\n"),
                           toSDMM_PlugIn(1, dec, true), SD * 60, HP * 60);
 }
 
+double Sight::Dip(double eyeheight, double dipshortdistance) {
+  if (dipshortdistance)
+    return r_to_d(atan(eyeheight / (0.3048 * 6076 * dipshortdistance) +
+                       dipshortdistance / 8268));
+  return 1.758 * sqrt(eyeheight) / 60.0;
+}
+
 void Sight::RecomputeAltitude() {
   double rad;
   double planet_dist;
@@ -639,9 +1040,7 @@ void Sight::RecomputeAltitude() {
         m_CalcStr += wxString::Format(_("Dip Short Distance cannot be 0 !\n"));
         return;
       }
-      EyeHeightCorrection =
-          r_to_d(atan(m_EyeHeight / (0.3048 * 6076 * m_DipShortDistance) +
-                      m_DipShortDistance / 8268));
+      EyeHeightCorrection = Dip(m_EyeHeight, m_DipShortDistance);
       m_CalcStr += wxString::Format(
           _("Dip Short Distance = %.4f nm\n\
 Eye Height = %.4f m = %.4f ft\n\
@@ -655,7 +1054,7 @@ Height Correction = %.4f%c = %s\n"),
     } else {
       /* correct for height of observer
          The dip of the sea horizon in minutes = 1.758*sqrt(height) */
-      EyeHeightCorrection = 1.758 * sqrt(m_EyeHeight) / 60.0;
+      EyeHeightCorrection = Dip(m_EyeHeight, 0);
       m_CalcStr += wxString::Format(
           _("Eye Height = %.4f m\n\
 Height Correction = (1.758 * sqrt(Eye Height)) / 60\n\
@@ -669,6 +1068,7 @@ Height Correction = %.4f%c = %s\n"),
   /* Apparent Altitude Ha */
   double ApparentAltitude =
       m_Measurement - IndexCorrection - EyeHeightCorrection;
+  m_MeasurementScale = 1;
   m_CalcStr +=
       wxString::Format(_("\nApparent Altitude (Ha)\n\
 ApparentAltitude = Hs - IndexCorrection - EyeHeightCorrection\n\
@@ -685,6 +1085,7 @@ ApparentAltitude = %.4f%c / 2 = %.4f%c\n"),
                                   ApparentAltitude, 0x00B0,
                                   ApparentAltitude / 2, 0x00B0);
     ApparentAltitude /= 2;
+    m_MeasurementScale /= 2;
   }
 
   /* Backsight ? */
@@ -696,6 +1097,7 @@ ApparentAltitude = 180%c - %.4f%c = %.4f%c\n"),
                          0x00B0, ApparentAltitude, 0x00B0, 0x00B0,
                          180 - ApparentAltitude, 0x00B0);
     ApparentAltitude = 180 - ApparentAltitude;
+    m_MeasurementScale = -m_MeasurementScale;
   }
 
   /* compensate for refraction */
@@ -717,6 +1119,7 @@ x = %.4f\n"),
                                 ApparentAltitude, ApparentAltitude, x);
   RefractionCorrection =
       .267 * m_Pressure / (x * (m_Temperature + 273.15)) / 60.0;
+  m_RefractionCorrection = RefractionCorrection;
   m_CalcStr += wxString::Format(_("\
 RefractionCorrection = .267%c * Pressure / (x * (Temperature + 273.15)) / 60.0\n\
 RefractionCorrection = .267%c * %.4f / (x * (%.4f + 273.15)) / 60.0\n\
@@ -1406,7 +1809,8 @@ void Sight::EstimateHs(double hc, double *hs, double *error) {
   *error = (ho - hc) * 60;
 }
 
-void Sight::RebuildPolygonsAltitude() {
+void Sight::RebuildPolygonsAltitude(double step,
+                                    const std::atomic<bool>* cancel) {
   polygons.clear();
   lines.clear();
 
@@ -1421,8 +1825,8 @@ void Sight::RebuildPolygonsAltitude() {
   timemax = +m_TimeCertainty;
   //      timestep = ComputeStepSize(m_TimeCertainty, 1, timemin, timemax);
   timestep = wxMax(2 * m_TimeCertainty, 1);
-  BuildAltitudeLineOfPosition(1, altitudemin, altitudemax, altitudestep,
-                              timemin, timemax, timestep);
+  BuildAltitudeLineOfPosition(step, altitudemin, altitudemax, altitudestep,
+                              timemin, timemax, timestep, cancel);
 }
 
 /* Calculate latitude and longitude position for a sight taken with time,
@@ -1486,44 +1890,46 @@ void Sight::AltitudeAzimuth(double lat1, double lon1, double lat2, double lon2,
 void Sight::BuildAltitudeLineOfPosition(double tracestep, double altitudemin,
                                         double altitudemax, double altitudestep,
                                         double timemin, double timemax,
-                                        double timestep) {
+                                        double timestep,
+                                        const std::atomic<bool>* cancel) {
   for (double time = timemin; time <= timemax; time += timestep) {
+    if (cancel && *cancel) return;
+
     double lat, lon;
     BodyLocation(m_CorrectedDateTime + wxTimeSpan::Seconds(time), &lat, &lon, 0,
                  0, 0);
-    wxRealPointList *p, *l = new wxRealPointList;
+    m_BandCenters.push_back(wxRealPoint(lat, lon));
+    m_LineBands.push_back(lines.GetCount());
+
+    /* the band lies between the lowest and highest altitude circles, the
+       line goes through the middle */
+    std::vector<wxRealPoint> outer, inner;
     for (double trace = -180; trace <= 180; trace += tracestep) {
-      p = new wxRealPointList;
       double mx = 0;
       double my = 0;
       int mc = 0;
+      wxRealPoint point;
       for (double altitude = altitudemin;
            altitude <= altitudemax && fabs(altitude) <= 90;
            altitude += altitudestep) {
-        wxRealPoint* point =
-            new wxRealPoint(DistancePoint(altitude, trace, lat, lon));
-        p->Append(point);
-        mx += point->x;
-        my += point->y;
+        point = DistancePoint(altitude, trace, lat, lon);
+        if (mc == 0) outer.push_back(point);
+        mx += point.x;
+        my += point.y;
         mc++;
         if (altitudestep == 0) break;
       }
-      if (mc > 0) lines.Append(new wxRealPoint(mx / mc, my / mc));
-      wxRealPointList* m = MergePoints(l, p);
-      wxRealPointList* n = ReduceToConvexPolygon(m);
-      polygons.push_back(n);
-
-      m->DeleteContents(true);
-      delete m;
-      l->DeleteContents(true);
-      delete l;
-
-      l = p;
+      if (mc > 0) {
+        lines.Append(new wxRealPoint(mx / mc, my / mc));
+        inner.push_back(point);
+      }
     }
+    BuildBand(outer, inner);
   }
 }
 
-void Sight::RebuildPolygonsAzimuth() {
+void Sight::RebuildPolygonsAzimuth(double step,
+                                   const std::atomic<bool>* cancel) {
   polygons.clear();
   lines.clear();
 
@@ -1539,40 +1945,64 @@ void Sight::RebuildPolygonsAzimuth() {
   //    timestep = ComputeStepSize(m_TimeCertainty, 1, timemin, timemax);
   timestep = wxMax(2 * m_TimeCertainty, 1);
 
-  BuildBearingLineOfPosition(1, azimuthmin, azimuthmax, azimuthstep, timemin,
-                             timemax, timestep);
+  BuildBearingLineOfPosition(step, azimuthmin, azimuthmax, azimuthstep,
+                             timemin, timemax, timestep, cancel);
 }
 
-/* find latitude and longitude which sees the body at the time, altitude and
-   bearing iterative method so we can easily support magnetic variation */
-bool Sight::BearingPoint(double altitude, double bearing, double& rlat,
-                         double& rlon, double& trace, double& lastlat,
-                         double& lastlon, double lat, double lon) {
-  double localbearing = bearing;
+/* great circle distance in degrees between two positions */
+static double GreatCircleDistance(double lat1, double lon1, double lat2,
+                                  double lon2) {
+  double lat1_r = d_to_r(lat1), lat2_r = d_to_r(lat2);
+  double dlon_r = d_to_r(lon2 - lon1);
+  double c =
+      sin(lat1_r) * sin(lat2_r) + cos(lat1_r) * cos(lat2_r) * cos(dlon_r);
+  return r_to_d(acos(wxMax(-1.0, wxMin(1.0, c))));
+}
+
+/* find latitude and longitude at distance degrees from the geographical
+   position (lat, lon) from which the body is seen at true azimuth.
+
+   The navigational triangle gives
+     sin(lat) = sin(rlat) * cos(distance) +
+                cos(rlat) * sin(distance) * cos(azimuth)
+   which is solved directly for rlat.  There are up to two roots, branch
+   selects which one is returned. */
+bool Sight::BearingPoint(double distance, double azimuth, int branch,
+                         double& rlat, double& rlon, double lat, double lon) {
+  double distance_r = d_to_r(distance);
+  double azimuth_r = d_to_r(azimuth);
+  double lat_r = d_to_r(lat);
+
+  double a = cos(distance_r), b = sin(distance_r) * cos(azimuth_r);
+  double r = hypot(a, b);
+  if (r == 0 || fabs(sin(lat_r)) > r) return false;
+
+  double phi = atan2(b, a), s = asin(sin(lat_r) / r);
+  double rlat_r = remainder(branch ? pi - s - phi : s - phi, 2 * pi);
+  if (fabs(rlat_r) > pi / 2) return false;
 
-  localbearing = resolve_heading(localbearing);
+  double y = sin(distance_r) * sin(azimuth_r) * cos(rlat_r);
+  double x = cos(distance_r) - sin(rlat_r) * sin(lat_r);
 
-  double rangle;
+  rlat = r_to_d(rlat_r);
+  rlon = resolve_heading(lon - r_to_d(atan2(y, x)));
+  return true;
+}
+
+/* find the point one degree on from (lastlat, lastlon) from which the body
+   at (lat, lon) is seen at magnetic bearing.  Iterates on the direction of the
+   step, starting from trace, and updates it for the next step. */
+bool Sight::MagneticBearingPoint(double bearing, double& rlat, double& rlon,
+                                 double& trace, double lastlat, double lastlon,
+                                 double lat, double lon) {
+  double rangle = 0;
   double mdb = 1000;
   double mdl = 1001;
   double b;
-  if (trace > 999) {
-    lastlat = lat;
-    lastlon = lon;
-
-    /* apply magnetic correction to bearing */
-    if (m_bMagneticNorth) {
-      localbearing += celestial_navigation_pi_GetWMM(lat, lon, m_EyeHeight,
-                                                     m_CorrectedDateTime);
-    }
-    trace = localbearing + 180;
-  }
 
   trace = resolve_heading(trace);
 
   while ((fabs(mdb) < fabs(mdl)) && (fabs(mdb) > .001)) {
-    //       ll_gc_ll(lat, lon, trace, 60*(90-altitude), &rlat, &rlon);
-    //       ll_gc_ll_reverse(rlat, rlon, lat, lon, &b, 0);
     mdl = mdb;
 
     double y, x, yy, xx;
@@ -1583,7 +2013,6 @@ bool Sight::BearingPoint(double altitude, double bearing, double& rlat,
     double rlat_r, rlon_r, backbearing_r;
     double lastlat_r = d_to_r(lastlat);
     double lastlon_r = d_to_r(lastlon);
-    double rangle_r;
 
     rlat_r = asin(sin(lastlat_r) * cos(dang_r) +
                   cos(lastlat_r) * sin(dang_r) * cos(trace_r));
@@ -1601,17 +2030,10 @@ bool Sight::BearingPoint(double altitude, double bearing, double& rlat,
 
     rlon = resolve_heading(rlon);
 
-    b = r_to_d(backbearing_r);
+    b = r_to_d(backbearing_r) - MagneticVariation(rlat, rlon);
+    if (isnan(b)) return false;
 
-    rangle_r = acos(sin(lat_r) * sin(rlat_r) +
-                    cos(lat_r) * cos(rlat_r) * cos(rlon_r - lon_r));
-    rangle = r_to_d(rangle_r);
-
-    /* apply magnetic correction to bearing */
-    if (m_bMagneticNorth) {
-      b -= celestial_navigation_pi_GetWMM(rlat, rlon, m_EyeHeight,
-                                          m_CorrectedDateTime);
-    }
+    rangle = GreatCircleDistance(lat, lon, rlat, rlon);
 
     mdb = bearing - b;
     mdb = resolve_heading(mdb);
@@ -1623,77 +2045,129 @@ bool Sight::BearingPoint(double altitude, double bearing, double& rlat,
   return ((fabs(mdb) < .1) && (fabs(rangle) < 90.0));
 }
 
-void Sight::BuildBearingLineOfPosition(double altitudestep, double azimuthmin,
+/* trace the line of position for a single azimuth outward from the
+   geographical position (lat, lon), giving points distancestep degrees apart
+   along the curve and limited to 200 degrees of curve.
+
+   For true azimuth the curve is followed by distance from the geographical
+   position using BearingPoint until that distance stops increasing, where
+   the first root meets the second and the curve continues back along it.
+   Steps are halved wherever consecutive points would be more than a degree
+   apart.
+
+   Magnetic azimuth depends on the variation at each point, which makes the
+   closed form ill conditioned where the curve folds, so instead it is
+   followed in one degree steps with MagneticBearingPoint. */
+void Sight::BuildBearingCurve(double azimuth, double distancestep, double lat,
+                              double lon, std::vector<wxRealPoint>& curve) {
+  std::vector<wxRealPoint> points;
+  points.push_back(wxRealPoint(lat, lon));
+
+  if (m_bMagneticNorth) {
+    double trace = MagneticVariation(lat, lon);
+    trace = resolve_heading(azimuth + (isnan(trace) ? 0 : trace) + 180);
+
+    double rlat, rlon;
+    while (points.size() <= 200 &&
+           MagneticBearingPoint(azimuth, rlat, rlon, trace, points.back().x,
+                                points.back().y, lat, lon))
+      points.push_back(wxRealPoint(wxMax(-90.0, wxMin(90.0, rlat)), rlon));
+  } else {
+    int branch = 0;
+    double distance = 0, step = 1;
+    while (points.size() < 10000) {
+      double d = distance + (branch ? -step : step), rlat, rlon;
+      if (d > 0 && d < 90 &&
+          BearingPoint(d, azimuth, branch, rlat, rlon, lat, lon) &&
+          GreatCircleDistance(points.back().x, points.back().y, rlat, rlon) <=
+              1) {
+        points.push_back(wxRealPoint(rlat, rlon));
+        distance = d;
+        step = wxMin(2 * step, 1.0);
+        continue;
+      }
+
+      if (step > 1e-8) {
+        step /= 2;
+        continue;
+      }
+
+      /* switch roots if the curve folds back here */
+      if (branch == 0 &&
+          BearingPoint(distance, azimuth, 1, rlat, rlon, lat, lon) &&
+          GreatCircleDistance(points.back().x, points.back().y, rlat, rlon) <
+              .01) {
+        branch = 1;
+        step = 1;
+        continue;
+      }
+      break;
+    }
+  }
+
+  /* resample at even spacing along the curve */
+  curve.push_back(points.front());
+  double length = 0, next = distancestep;
+  for (size_t i = 1; i < points.size(); i++) {
+    wxRealPoint& p1 = points[i - 1];
+    wxRealPoint& p2 = points[i];
+    double s = GreatCircleDistance(p1.x, p1.y, p2.x, p2.y);
+    while (s > 0 && length + s >= next) {
+      if (next > 200) return;
+      double hc, zn;
+      AltitudeAzimuth(p1.x, p1.y, p2.x, p2.y, &hc, &zn);
+      curve.push_back(DistancePoint(90 - (next - length), zn, p1.x, p1.y));
+      curve.back().y = resolve_heading(curve.back().y);
+      next += distancestep;
+    }
+    length += s;
+  }
+}
+
+void Sight::BuildBearingLineOfPosition(double distancestep, double azimuthmin,
                                        double azimuthmax, double azimuthstep,
                                        double timemin, double timemax,
-                                       double timestep) {
+                                       double timestep,
+                                       const std::atomic<bool>* cancel) {
   for (double time = timemin; time <= timemax; time += timestep) {
-    double lasttrace[100];
-    for (int i = 0; i < 100; i++) lasttrace[i] = 1000.0;
-
-    double lastlat[100];
-    double lastlon[100];
-    double trace;
-
     double blat, blon;
 
     BodyLocation(m_CorrectedDateTime + wxTimeSpan::Seconds(time), &blat, &blon,
                  0, 0, 0);
 
     blon = resolve_heading(blon);
+    m_LineBands.push_back(lines.GetCount());
+
+    std::list<std::vector<wxRealPoint> > curves;
+    size_t length = 0;
+    for (double azimuth = azimuthmin; azimuth <= azimuthmax;
+         azimuth += azimuthstep) {
+      if (cancel && *cancel) return;
+      curves.push_back(std::vector<wxRealPoint>());
+      BuildBearingCurve(azimuth, distancestep, blat, blon, curves.back());
+      length = wxMax(length, curves.back().size());
+      if (azimuthstep == 0) break;
+    }
 
-    /* sometimes it takes a long time to build magnetic azimuth sights */
-    wxProgressDialog progressdialog(
-        _("Celestial Navigation"), _("Building bearing Sight Positions"), 201,
-        NULL, wxPD_SMOOTH | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME);
-
-    wxRealPointList *p, *l = new wxRealPointList;
-    l->Append(new wxRealPoint(blat, blon));
-    for (double altitude = 200; altitude >= 0; altitude -= 1) {
-      if (m_bMagneticNorth && (int)altitude % 10 == 0)
-        progressdialog.Update(200 - altitude);
-
-      p = new wxRealPointList;
-      int index = 0;
+    for (size_t i = 1; i < length; i++) {
       double mx = 0;
       double my = 0;
       int mc = 0;
-      double lat, lon, llat, llon;
-      for (double azimuth = azimuthmin; azimuth <= azimuthmax;
-           azimuth += azimuthstep) {
-        trace = lasttrace[index];
-        llat = lastlat[index];
-        llon = lastlon[index];
-        if (BearingPoint(altitude, azimuth, lat, lon, trace, llat, llon, blat,
-                         blon)) {
-          if (lat > 90)
-            lat = 90.0;
-          else if (lat < -90)
-            lat = -90.0;
-
-          {
-            wxRealPoint* point = new wxRealPoint(lat, lon);
-            mx += point->x;
-            my += point->y;
-            mc++;
-            p->Append(point);
-            lasttrace[index] = trace;
-
-            lastlat[index] = lat;
-            lastlon[index] = lon;
-          }
-        }
-        index += 1;
+      for (std::list<std::vector<wxRealPoint> >::iterator it = curves.begin();
+           it != curves.end(); it++) {
+        if (i >= it->size()) continue;
+        mx += (*it)[i].x;
+        my += (*it)[i].y;
+        mc++;
       }
       if (mc > 0) lines.Append(new wxRealPoint(mx / mc, my / mc));
-      wxRealPointList* m = MergePoints(l, p);
-      wxRealPointList* n = ReduceToConvexPolygon(m);
-      polygons.push_back(n);
-      m->DeleteContents(true);
-      delete m;
-      l->DeleteContents(true);
-      delete l;
-      l = p;
     }
+
+    /* the band lies between the outermost bearings, the shorter side is
+       held at its last point while the longer one continues */
+    std::vector<wxRealPoint> side1 = curves.front(), side2 = curves.back();
+    side1.resize(length, wxRealPoint(side1.back()));
+    side2.resize(length, wxRealPoint(side2.back()));
+    BuildBand(side1, side2);
   }
 }
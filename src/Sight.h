@@ -25,7 +25,11 @@
  *
  */
 
+#include <atomic>
 #include <list>
+#include <map>
+#include <memory>
+#include <vector>
 #include "pidc.h"
 
 #ifdef __MSVC__
@@ -51,6 +55,59 @@
 
 WX_DECLARE_LIST(wxRealPoint, wxRealPointList);
 
+//    SightExtent
+//----------------------------------------------------------------------------
+
+/* lat/lon bounding box of sight geometry.  Longitudes are tracked both in
+   -180..180 and 0..360 so boxes crossing the antimeridian stay narrow */
+class SightExtent {
+public:
+  SightExtent();
+
+  void Add(double lat, double lon);
+  bool Intersects(const PlugIn_ViewPort& VP) const;
+
+  double m_LatMin, m_LatMax;
+  double m_LonMin, m_LonSpan;  // eastward from m_LonMin, 360 if unbounded
+
+private:
+  double m_Lon180Min, m_Lon180Max, m_Lon360Min, m_Lon360Max;
+};
+
+/* how much of the overlay was drawn or culled in a frame */
+struct SightRenderStats {
+  SightRenderStats() : sights(0), sightsculled(0), polygons(0),
+                       polygonsculled(0), setupus(0), cached(false) {}
+
+  int sights, sightsculled;
+  int polygons, polygonsculled;
+  long setupus;  // drawing context setup time of the frame in microseconds
+  bool cached;   // drawn from the offscreen image, counters are all zero
+};
+
+/* the polygons and line points of one rebuild, freed with the last sight
+   or geometry still holding them */
+struct SightPoints {
+  ~SightPoints();
+
+  std::list<wxRealPointList*> polygons;
+  std::vector<wxRealPoint*> lines;
+};
+
+/* the lines of position RebuildPolygons builds, all a rebuild on a worker
+   thread hands back to the sight it was made for */
+struct SightGeometry {
+  std::shared_ptr<SightPoints> points;
+  std::list<wxRealPointList*> polygons;
+  wxRealPointList lines;
+  std::vector<size_t> linebands;
+  std::vector<wxRealPoint> bandcenters;
+  std::vector<SightExtent> extents;
+  SightExtent extent;
+  unsigned int id;
+  bool calculated;
+};
+
 //    Sight
 //----------------------------------------------------------------------------
 
@@ -67,7 +124,7 @@ public:
     UPPER = 2
   };
 
-  Sight() {}
+  Sight() : m_RebuildTicket(0), m_GeometryId(0), m_bProjected(false) {}
   Sight(Type type, wxString body, BodyLimb bodylimb, wxDateTime datetime,
         double timecertainty, double measurement, double measurementcertainty);
 
@@ -81,7 +138,11 @@ public:
   bool IsSelected() { return m_bSelected; }
 
   void Recompute(int clock_offset);
-  void RebuildPolygons();
+  /* step is the spacing in degrees of the line of position, larger for a
+     quick coarse result.  cancel, if given, is polled and abandons the
+     rebuild once set */
+  void RebuildPolygons(double step = 1,
+                       const std::atomic<bool>* cancel = NULL);
 
   wxString Alminac(wxDateTime time, double lat, double lon, double ghaast,
                    double rad, double SD, double HP);
@@ -89,8 +150,15 @@ public:
   void RecomputeAzimuth();
   void RecomputeLunar();
 
-  void RebuildPolygonsAltitude();
-  void RebuildPolygonsAzimuth();
+  /* take the geometry rebuilt on a copy of this sight, keeping everything
+     else as it is now */
+  void GetGeometry(SightGeometry& geometry) const;
+  void SetGeometry(const SightGeometry& geometry);
+
+  void RebuildPolygonsAltitude(double step = 1,
+                               const std::atomic<bool>* cancel = NULL);
+  void RebuildPolygonsAzimuth(double step = 1,
+                              const std::atomic<bool>* cancel = NULL);
 
   bool m_bVisible;  // should this sight be drawn?
   bool m_bCalculated;
@@ -125,13 +193,27 @@ public:
   wxString m_ColourName;
   wxColour m_Colour;  // Color of the sight
 
-  virtual void Render(piDC* dc, PlugIn_ViewPort& pVP, double pix_per_mm);
+  virtual void Render(piDC* dc, PlugIn_ViewPort& pVP, double pix_per_mm,
+                      SightRenderStats* stats = NULL);
+
+  /* zoom band of a viewport, the scale doubles from one band to the next */
+  static int ZoomBand(const PlugIn_ViewPort& VP);
+
+  /* Douglas-Peucker simplification of lat/lon points to within tolerance in
+     degrees of mercator projection.  A triangle strip alternates between its
+     two sides, which are simplified together */
+  static std::vector<wxRealPoint> Simplify(
+      const std::vector<wxRealPoint>& points, double tolerance, bool strip);
 
   void BodyLocation(wxDateTime time, double* lat, double* lon, double* ghaash,
                     double* rad, double* dist);
   void AltitudeAzimuth(double lat1, double lon1, double lat2, double lon2,
                        double* hc, double* zn);
   void EstimateHs(double hc, double *hs, double *error);
+
+  /* dip of the horizon in degrees for an eye height in meters, of a
+     horizon dipshortdistance nautical miles off if it is not 0 */
+  static double Dip(double eyeheight, double dipshortdistance);
   std::list<wxRealPoint> GetPoints();
 
   wxString m_CalcStr;
@@ -140,6 +222,10 @@ public:
 
   /* for altitude */
   double m_ObservedAltitude; /* after all corrections are applied */
+  /* change of the observed altitude with the measurement, 1/2 with an
+     artificial horizon and negative for a backsight */
+  double m_MeasurementScale;
+  double m_RefractionCorrection;  // in degrees, as applied
 
   /* for azimuth */
   bool m_bMagneticNorth;  // if azimuth angle is in magnetic coordinates
@@ -154,33 +240,101 @@ public:
   bool m_DRBoatPosition;
   bool m_DRMagneticAzimuth;
 
+  /* the background rebuild whose geometry is for this sight, 0 if none.
+     Rebuilding the polygons here drops it */
+  unsigned int m_RebuildTicket;
+
 protected:
-  double CalcAngle(wxRealPoint p1, wxRealPoint p2);
   double ComputeStepSize(double certainty, double stepsize, double min,
                          double max);
 
-  wxRealPointList* MergePoints(wxRealPointList* p1, wxRealPointList* p2);
-  wxRealPointList* ReduceToConvexPolygon(wxRealPointList* points);
+  void BuildBand(const std::vector<wxRealPoint>& side1,
+                 const std::vector<wxRealPoint>& side2);
 
   std::list<wxRealPointList*> polygons;
   wxRealPointList lines;
+  std::shared_ptr<SightPoints> m_Points;  // owns polygons and lines
+  unsigned int m_GeometryId;  // changes whenever the polygons are rebuilt
+
+  /* where the line of each time band starts in lines, they are not joined */
+  std::vector<size_t> m_LineBands;
+  size_t LineBandEnd(size_t band) const {
+    return band + 1 < m_LineBands.size() ? m_LineBands[band + 1]
+                                         : lines.GetCount();
+  }
+
+  /* geographic position of the body for each altitude band */
+  std::vector<wxRealPoint> m_BandCenters;
+
+  friend class SightRenderer;
+  friend class OverlayCache;
+  friend class SightIndex;
+  friend class FixEngine;
 
 private:
   wxRealPoint DistancePoint(double altitude, double trace, double lat,
                             double lon);
-  void BuildAltitudeLineOfPosition(double altitudemin, double altitudemax,
-                                   double altitudestep, double tracestep,
+  void BuildAltitudeLineOfPosition(double tracestep, double altitudemin,
+                                   double altitudemax, double altitudestep,
                                    double timemin, double timemax,
-                                   double timestep);
-  bool BearingPoint(double altitude, double trace, double& rlat, double& rlon,
-                    double& lasttrace, double& llat, double& llon, double lat,
-                    double lon);
-  void BuildBearingLineOfPosition(double altitudestep, double azimuthmin,
+                                   double timestep,
+                                   const std::atomic<bool>* cancel);
+  bool BearingPoint(double distance, double azimuth, int branch, double& rlat,
+                    double& rlon, double lat, double lon);
+  bool MagneticBearingPoint(double bearing, double& rlat, double& rlon,
+                            double& trace, double lastlat, double lastlon,
+                            double lat, double lon);
+  void BuildBearingCurve(double azimuth, double distancestep, double lat,
+                         double lon, std::vector<wxRealPoint>& curve);
+  void BuildBearingLineOfPosition(double distancestep, double azimuthmin,
                                   double azimuthmax, double azimuthstep,
                                   double timemin, double timemax,
-                                  double timestep);
-
-  void DrawPolygon(PlugIn_ViewPort& VP, wxRealPointList& area, bool poly);
+                                  double timestep,
+                                  const std::atomic<bool>* cancel);
+
+  /* screen coordinates of a polygon (or a line) for the cached viewport */
+  struct ProjectedArea {
+    std::vector<wxPoint> points;
+    bool projected;  // points are only filled in once the area is in view
+    bool rear;       // crosses the longitude opposite the viewport center
+  };
+  double m_RearLon;  // viewport center longitude the rear flags are for
+
+  void Project(PlugIn_ViewPort& VP);
+  void ProjectArea(PlugIn_ViewPort& VP, const std::vector<wxRealPoint>& area,
+                   ProjectedArea& projected);
+  bool UpdateRear(PlugIn_ViewPort& VP);
+  void DrawPolygon(const std::vector<wxRealPoint>& area,
+                   ProjectedArea& projected, bool poly);
+
+  /* polygons followed by the line of each time band, simplified to within a
+     pixel for a zoom band.  A few bands are kept and all are dropped when
+     the polygons are rebuilt */
+  typedef std::vector<std::vector<wxRealPoint> > Geometry;
+  const Geometry& Simplified(int band);
+  std::map<int, Geometry> m_Simplified;
+
+  /* projected polygons followed by the line of each time band, valid for
+     m_ProjectedVP translated on screen by m_ProjectedShift when drawn at
+     m_DrawnCenter */
+  std::vector<ProjectedArea> m_Projected;
+  PlugIn_ViewPort m_ProjectedVP;
+  wxPoint m_ProjectedCenter, m_ProjectedShift;
+  wxRealPoint m_DrawnCenter;
+  bool m_bProjected;
+  std::vector<wxPoint> m_ShiftedPoints;
+
+  double MagneticVariation(double lat, double lon);
+  void ComputeExtents();
+
+  /* extents of the polygons followed by the lines, and of the whole sight,
+     computed when the polygons are built */
+  std::vector<SightExtent> m_Extents;
+  SightExtent m_Extent;
+
+  /* magnetic variation sampled on a coarse lat/lon grid, filled on demand
+     and discarded whenever the polygons are rebuilt */
+  std::vector<double> m_VariationGrid;
 
   piDC* m_dc;
 
@@ -189,3 +343,4 @@ private:
 
 double resolve_heading(double heading);
 double resolve_heading_positive(double heading);
+double MercatorY(double lat);
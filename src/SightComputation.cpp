@@ -0,0 +1,95 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+
+#include "SightComputation.h"
+
+/* spacing in degrees of the quick first line of position */
+static const double s_CoarseStep = 5;
+
+SightComputation::SightComputation(wxEvtHandler* handler,
+                                   SightWorkerPool& workers)
+    : m_Handler(handler), m_Workers(workers) {}
+
+SightComputation::~SightComputation() { Cancel(); }
+
+void SightComputation::Submit(const Sight& sight, const Callback& callback) {
+  Cancel();
+
+  std::shared_ptr<Job> job = std::make_shared<Job>(m_Handler);
+  m_Job = job;
+
+  /* only the pointer is copied from here on, never the sight */
+  std::shared_ptr<Sight> s = std::make_shared<Sight>(sight);
+  Unshare(*s);
+  m_Workers.Submit([job, s, callback]() {
+    s->RebuildPolygons(s_CoarseStep, &job->cancelled);
+    Publish(job, *s, false, callback);
+
+    s->RebuildPolygons(1, &job->cancelled);
+    Publish(job, *s, true, callback);
+  });
+}
+
+void SightComputation::Cancel() {
+  std::shared_ptr<Job> job = m_Job;
+  m_Job.reset();
+  if (!job) return;
+
+  std::lock_guard<std::mutex> lock(job->mutex);
+  job->cancelled = true;
+  job->handler = NULL;
+}
+
+/* give the copy its own strings and colour so nothing it holds is shared
+   with the sights on the UI thread */
+void SightComputation::Unshare(Sight& sight) {
+  sight.m_Body = wxString(sight.m_Body.wc_str(), sight.m_Body.length());
+  sight.m_ColourName =
+      wxString(sight.m_ColourName.wc_str(), sight.m_ColourName.length());
+  sight.m_CalcStr = wxString(sight.m_CalcStr.wc_str(), sight.m_CalcStr.length());
+
+  wxColour colour = sight.m_Colour;
+  sight.m_Colour = colour.IsOk() ? wxColour(colour.Red(), colour.Green(),
+                                            colour.Blue(), colour.Alpha())
+                                 : wxColour();
+}
+
+void SightComputation::Publish(const std::shared_ptr<Job>& job,
+                               const Sight& sight, bool complete,
+                               const Callback& callback) {
+  std::lock_guard<std::mutex> lock(job->mutex);
+  if (job->cancelled) return;
+
+  SightGeometry geometry;
+  sight.GetGeometry(geometry);
+
+  /* the job may be superseded after this is queued, so check again once it
+     runs on the UI thread */
+  job->handler->CallAfter([job, geometry, complete, callback]() {
+    if (!job->cancelled) callback(geometry, complete);
+  });
+}
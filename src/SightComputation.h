@@ -0,0 +1,81 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+
+#ifndef _SIGHTCOMPUTATION_H_
+#define _SIGHTCOMPUTATION_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include <wx/wx.h>
+
+#include "Sight.h"
+#include "SightWorkerPool.h"
+
+/* Computes the line of position of a sight in the background.  Submitting a
+   sight cancels the job still running for the previous one, so while a sight
+   is being edited only the latest values are worked on.  Results are handed
+   to the callback on the UI thread, first a coarse line of position which
+   shows up almost at once, then the complete one.
+
+   wxString and wxColour share their data by reference counts which are not
+   thread safe, so the worker gets a copy of the sight holding its own, made
+   on the UI thread, and hands back only the geometry it rebuilt. */
+class SightComputation {
+public:
+  typedef std::function<void(const SightGeometry& geometry, bool complete)>
+      Callback;
+
+  SightComputation(wxEvtHandler* handler, SightWorkerPool& workers);
+  ~SightComputation();
+
+  /* the sight must already be recomputed */
+  void Submit(const Sight& sight, const Callback& callback);
+  void Cancel();
+
+private:
+  /* shared with the worker running it, which may outlive the request */
+  struct Job {
+    Job(wxEvtHandler* h) : handler(h), cancelled(false) {}
+
+    std::mutex mutex;  // held while results are posted to handler
+    wxEvtHandler* handler;
+    std::atomic<bool> cancelled;
+  };
+
+  static void Unshare(Sight& sight);
+  static void Publish(const std::shared_ptr<Job>& job, const Sight& sight,
+                      bool complete, const Callback& callback);
+
+  wxEvtHandler* m_Handler;
+  SightWorkerPool& m_Workers;
+  std::shared_ptr<Job> m_Job;
+};
+
+#endif  // _SIGHTCOMPUTATION_H_
@@ -45,11 +45,14 @@
 #include <wx/qt/private/wxQtGesture.h>
 #endif
 
-SightDialog::SightDialog(wxWindow* parent, Sight& s, int clock_offset)
+SightDialog::SightDialog(wxWindow* parent, Sight& s, int clock_offset,
+                         SightWorkerPool& workers)
     : SightDialogBase(parent),
       m_Sight(s),
       m_clock_offset(clock_offset),
-      m_breadytorecompute(false) {
+      m_breadytorecompute(false),
+      m_bComplete(false),
+      m_Computation(this, workers) {
   m_cBody->Append(_T("Sun"));
   m_cBody->Append(_T("Moon"));
   m_cBody->Append(_T("Mercury"));
@@ -447,9 +450,28 @@ void SightDialog::Recompute() {
   m_Sight.Recompute(m_clock_offset);
   m_tCalculations->SetValue(m_Sight.m_CalcStr);
 
+  /* rebuild the line of position in the background, replacing any rebuild
+     still running for earlier values */
+  if (m_Sight.m_bVisible)
+    m_Computation.Submit(
+        m_Sight, std::bind(&SightDialog::OnPolygonsComputed, this,
+                           std::placeholders::_1, std::placeholders::_2));
+  else
+    m_Computation.Cancel();
+  m_bComplete = false;
+
   Refresh();
 }
 
+/* the sight may have been edited since the job started, so only its
+   geometry is taken */
+void SightDialog::OnPolygonsComputed(const SightGeometry& geometry,
+                                     bool complete) {
+  m_Sight.SetGeometry(geometry);
+  m_bComplete = complete;
+  RequestRefresh(GetParent()->GetParent());
+}
+
 double SightDialog::BodyAltitude(wxString body) {
   Sight lunar(Sight::ALTITUDE, body, Sight::CENTER, wxDateTime::Now(), 0, 0, 0);
   double lat1, lat2, lon1, lon2;
@@ -32,18 +32,18 @@
 #include "wx/calctrl.h"
 
 #include "CelestialNavigationUI.h"
+#include "SightComputation.h"
 
 #ifdef __OCPN__ANDROID__
 #include <wx/qt/private/wxQtGesture.h>
 #endif
 
-class Sight;
-
 class SightDialog : public SightDialogBase {
 public:
   enum { ALTITUDE, AZIMUTH, LUNAR };
 
-  SightDialog(wxWindow* parent, Sight& sight, int clock_offset);
+  SightDialog(wxWindow* parent, Sight& sight, int clock_offset,
+              SightWorkerPool& workers);
   ~SightDialog();
 
   //    void SetColorScheme(ColorScheme cs);
@@ -71,8 +71,12 @@ public:
   void Recompute();
   void RecomputeDMM();
 
+  /* whether the sight holds the complete line of position for its values */
+  bool Complete() const { return m_bComplete; }
+
 private:
   double BodyAltitude(wxString body);
+  void OnPolygonsComputed(const SightGeometry& geometry, bool complete);
 #ifdef __OCPN__ANDROID__
   void OnEvtPanGesture(wxQT_PanGestureEvent& event);
 #endif
@@ -80,6 +84,9 @@ private:
   Sight& m_Sight;
   int m_clock_offset;
   bool m_breadytorecompute;
+  bool m_bComplete;
+
+  SightComputation m_Computation;  // previews the sight on the chart
 
   int m_lastPanX;
   int m_lastPanY;
@@ -0,0 +1,195 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif
+
+#include <algorithm>
+
+#include "SightIndex.h"
+#include "Sight.h"
+#include "celestial_navigation_pi.h"
+
+/* size of the grid cells in degrees */
+static const int s_CellDegrees = 2;
+static const int s_Rows = 180 / s_CellDegrees;
+static const int s_Columns = 360 / s_CellDegrees;
+
+SightIndex::SightIndex() : m_Cells(s_Rows * s_Columns) {}
+
+int SightIndex::Row(double lat) {
+  return wxMax(0, wxMin(s_Rows - 1, (int)floor((lat + 90) / s_CellDegrees)));
+}
+
+/* column counted from 180W, not wrapped */
+int SightIndex::Column(double lon) {
+  return (int)floor((lon + 180) / s_CellDegrees);
+}
+
+void SightIndex::Update(std::vector<Sight>& sights) {
+  std::vector<unsigned int> keys;
+  for (Sight& s : sights) keys.push_back(s.IsVisible() ? s.m_GeometryId : 0);
+  if (keys == m_Keys) return;
+  m_Keys.swap(keys);
+
+  m_Pieces.clear();
+  for (std::vector<int>& cell : m_Cells) cell.clear();
+
+  std::vector<wxRealPoint> points;
+  for (size_t i = 0; i < sights.size(); i++) {
+    Sight& s = sights[i];
+    if (!s.IsVisible()) continue;
+
+    Piece piece;
+    piece.sight = i;
+
+    /* the bands are triangle strips alternating between their sides, each
+       step along them is a quad */
+    piece.line = false;
+    for (std::list<wxRealPointList*>::iterator it = s.polygons.begin();
+         it != s.polygons.end(); it++) {
+      points.clear();
+      for (wxRealPointList::iterator it2 = (*it)->begin();
+           it2 != (*it)->end(); it2++)
+        points.push_back(**it2);
+      for (size_t k = 0; k + 3 < points.size(); k += 2) {
+        for (int j = 0; j < 4; j++) {
+          piece.lat[j] = points[k + j].x;
+          piece.lon[j] = points[k + j].y;
+        }
+        Add(piece);
+      }
+    }
+
+    /* the line of each time band is a separate polyline */
+    piece.line = true;
+    wxRealPointList::iterator it = s.lines.begin();
+    for (size_t band = 0; band < s.m_LineBands.size(); band++) {
+      points.clear();
+      for (size_t k = s.m_LineBands[band]; k < s.LineBandEnd(band); k++, it++)
+        points.push_back(**it);
+      for (size_t k = 0; k + 1 < points.size(); k++) {
+        for (int j = 0; j < 4; j++) {
+          piece.lat[j] = points[k + j % 2].x;
+          piece.lon[j] = points[k + j % 2].y;
+        }
+        Add(piece);
+      }
+    }
+  }
+}
+
+/* file the piece under every cell its bounds touch */
+void SightIndex::Add(const Piece& piece) {
+  int index = m_Pieces.size();
+  m_Pieces.push_back(piece);
+
+  double latmin = piece.lat[0], latmax = piece.lat[0];
+  double lonmin = piece.lon[0], lonmax = piece.lon[0];
+  for (int j = 1; j < 4; j++) {
+    double lon = piece.lon[0] + resolve_heading(piece.lon[j] - piece.lon[0]);
+    latmin = wxMin(latmin, piece.lat[j]);
+    latmax = wxMax(latmax, piece.lat[j]);
+    lonmin = wxMin(lonmin, lon);
+    lonmax = wxMax(lonmax, lon);
+  }
+
+  int c0 = Column(lonmin), c1 = wxMin(Column(lonmax), c0 + s_Columns - 1);
+  for (int r = Row(latmin); r <= Row(latmax); r++)
+    for (int c = c0; c <= c1; c++)
+      m_Cells[r * s_Columns + (c % s_Columns + s_Columns) % s_Columns]
+          .push_back(index);
+}
+
+void SightIndex::Find(double lat, double lon, double tolerance,
+                      std::vector<int>& found) {
+  found.clear();
+
+  /* longitude degrees shrink toward the poles */
+  double lontolerance = tolerance / wxMax(cos(d_to_r(lat)), 0.01);
+  lontolerance = wxMin(180.0, lontolerance);
+  lon = resolve_heading(lon);
+  int c0 = Column(lon - lontolerance);
+  int c1 = wxMin(Column(lon + lontolerance), c0 + s_Columns - 1);
+  for (int r = Row(lat - tolerance); r <= Row(lat + tolerance); r++)
+    for (int c = c0; c <= c1; c++) {
+      std::vector<int>& cell =
+          m_Cells[r * s_Columns + (c % s_Columns + s_Columns) % s_Columns];
+      for (int index : cell) {
+        const Piece& piece = m_Pieces[index];
+        if (!found.empty() && found.back() == piece.sight) continue;
+        if (Hit(piece, lat, lon, tolerance)) found.push_back(piece.sight);
+      }
+    }
+
+  std::sort(found.begin(), found.end());
+  found.erase(std::unique(found.begin(), found.end()), found.end());
+}
+
+/* distance from the origin to the segment from a to b */
+static double OriginDistance(double ax, double ay, double bx, double by) {
+  double dx = bx - ax, dy = by - ay;
+  double l = dx * dx + dy * dy;
+  double t = l > 0 ? -(ax * dx + ay * dy) / l : 0;
+  t = wxMax(0.0, wxMin(1.0, t));
+  return hypot(ax + t * dx, ay + t * dy);
+}
+
+/* whether the origin is inside a triangle that is not degenerate */
+static bool ContainsOrigin(const double x[], const double y[], int a, int b,
+                           int c) {
+  double d0 = x[a] * y[b] - x[b] * y[a];
+  double d1 = x[b] * y[c] - x[c] * y[b];
+  double d2 = x[c] * y[a] - x[a] * y[c];
+  if (d0 + d1 + d2 == 0) return false;
+  return (d0 >= 0 && d1 >= 0 && d2 >= 0) || (d0 <= 0 && d1 <= 0 && d2 <= 0);
+}
+
+/* test in a plane tangent at the position, in degrees of arc */
+bool SightIndex::Hit(const Piece& piece, double lat, double lon,
+                     double tolerance) {
+  double x[4], y[4];
+  double coslat = cos(d_to_r(lat));
+  for (int j = 0; j < 4; j++) {
+    x[j] = resolve_heading(piece.lon[j] - lon) * coslat;
+    y[j] = piece.lat[j] - lat;
+  }
+
+  if (piece.line) return OriginDistance(x[0], y[0], x[1], y[1]) <= tolerance;
+
+  if (ContainsOrigin(x, y, 0, 1, 2) || ContainsOrigin(x, y, 1, 3, 2))
+    return true;
+
+  static const int edges[4][2] = {{0, 1}, {1, 3}, {3, 2}, {2, 0}};
+  for (int e = 0; e < 4; e++) {
+    int a = edges[e][0], b = edges[e][1];
+    if (OriginDistance(x[a], y[a], x[b], y[b]) <= tolerance) return true;
+  }
+  return false;
+}
@@ -0,0 +1,67 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#ifndef _SIGHTINDEX_H_
+#define _SIGHTINDEX_H_
+
+#include <vector>
+
+class Sight;
+
+/* Grid over latitude and longitude holding every quad of the sight bands
+   and every segment of their lines, so the sights under a position are
+   found by testing the few pieces in its cells. */
+class SightIndex {
+public:
+  SightIndex();
+
+  /* index the visible sights, nothing to do unless their geometry changed */
+  void Update(std::vector<Sight>& sights);
+
+  /* indices of the sights with a band containing lat, lon or a line within
+     tolerance degrees of it, each once and in order */
+  void Find(double lat, double lon, double tolerance, std::vector<int>& found);
+
+private:
+  /* a quad of a band, or a segment of a line with the last two points the
+     same as the first two.  Coordinates are latitude and longitude */
+  struct Piece {
+    int sight;
+    bool line;
+    float lat[4], lon[4];
+  };
+
+  void Add(const Piece& piece);
+  bool Hit(const Piece& piece, double lat, double lon, double tolerance);
+  static int Row(double lat);
+  static int Column(double lon);
+
+  std::vector<Piece> m_Pieces;
+  std::vector<std::vector<int> > m_Cells;  // pieces in each cell
+  std::vector<unsigned int> m_Keys;  // geometry of each sight, 0 if hidden
+};
+
+#endif
@@ -0,0 +1,319 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif
+
+#include <cstddef>
+
+#include "SightRenderer.h"
+#include "Sight.h"
+#include "celestial_navigation_pi.h"
+
+#ifdef USE_ANDROID_GLES2
+#include "pi_shaders.h"
+#endif
+
+/* past this many pixels per degree, float world coordinates are no longer
+   accurate to a pixel on screen */
+static const double s_MaxPixelsPerDegree = 10000;
+
+SightRenderer::SightRenderer()
+    : m_Band(0), m_TriangleVertices(0), m_LineVertices(0) {
+#ifdef USE_ANDROID_GLES2
+  m_Buffer = 0;
+  m_bUploaded = false;
+#endif
+}
+
+SightRenderer::~SightRenderer() {
+#ifdef USE_ANDROID_GLES2
+  if (m_Buffer) glDeleteBuffers(1, &m_Buffer);
+#endif
+}
+
+void SightRenderer::Build(const std::vector<Sight*>& sights, int band) {
+  std::vector<Vertex> lines;
+  m_Vertices.clear();
+
+  for (Sight* s : sights) {
+#ifdef USE_ANDROID_GLES2
+    if (Analytic(s)) continue;
+#endif
+    Vertex v;
+    v.rgba[0] = s->m_Colour.Red();
+    v.rgba[1] = s->m_Colour.Green();
+    v.rgba[2] = s->m_Colour.Blue();
+    v.rgba[3] = s->m_Colour.Alpha();
+
+    const Sight::Geometry& geometry = s->Simplified(band);
+
+    /* polygons are triangle strips, their longitudes are unwrapped so
+       pieces ending past the antimeridian stay in one piece */
+    size_t npolygons = s->polygons.size();
+    for (size_t p = 0; p < npolygons; p++) {
+      const std::vector<wxRealPoint>& strip = geometry[p];
+      if (strip.size() < 3) continue;
+      double lon0 = strip[0].y;
+      for (size_t i = 0; i < strip.size(); i++) {
+        v.x = lon0 + resolve_heading(strip[i].y - lon0);
+        v.y = MercatorY(strip[i].x);
+        if (i >= 3) {
+          Vertex a = m_Vertices[m_Vertices.size() - 2], b = m_Vertices.back();
+          m_Vertices.push_back(a);
+          m_Vertices.push_back(b);
+        }
+        m_Vertices.push_back(v);
+      }
+    }
+
+    /* the line of each time band as separate segments, each unwrapped from
+       its start */
+    for (size_t p = npolygons; p < geometry.size(); p++) {
+      const std::vector<wxRealPoint>& line = geometry[p];
+      for (size_t i = 1; i < line.size(); i++) {
+        Vertex last = v;
+        last.x = resolve_heading(line[i - 1].y);
+        last.y = MercatorY(line[i - 1].x);
+        v.x = last.x + resolve_heading(line[i].y - line[i - 1].y);
+        v.y = MercatorY(line[i].x);
+        lines.push_back(last);
+        lines.push_back(v);
+      }
+    }
+  }
+
+  m_TriangleVertices = m_Vertices.size();
+  m_LineVertices = lines.size();
+  m_Vertices.insert(m_Vertices.end(), lines.begin(), lines.end());
+#ifdef USE_ANDROID_GLES2
+  m_bUploaded = false;
+#endif
+}
+
+bool SightRenderer::Render(const std::vector<Sight*>& sights,
+                           PlugIn_ViewPort& VP, double pix_per_mm) {
+  if (VP.m_projection_type != PI_PROJECTION_MERCATOR) return false;
+
+  /* the viewport as an affine map from world coordinates, found by
+     projecting a degree of longitude and of latitude from the center */
+  double y0 = MercatorY(VP.clat);
+  double lat1 = VP.clat > 0 ? VP.clat - 1 : VP.clat + 1;
+  double dy = MercatorY(lat1) - y0;
+  wxPoint2DDouble s0, s1, s2;
+  GetDoubleCanvasPixLL(&VP, &s0, VP.clat, VP.clon);
+  GetDoubleCanvasPixLL(&VP, &s1, VP.clat, VP.clon + 1);
+  GetDoubleCanvasPixLL(&VP, &s2, lat1, VP.clon);
+  double ax = s1.m_x - s0.m_x, ay = s1.m_y - s0.m_y;
+  double bx = (s2.m_x - s0.m_x) / dy, by = (s2.m_y - s0.m_y) / dy;
+
+  double scale = hypot(ax, ay);
+  if (scale == 0 || scale > s_MaxPixelsPerDegree) return false;
+
+  /* geometry is simplified for the zoom band, so it is rebuilt on zoom */
+  int band = Sight::ZoomBand(VP);
+  std::vector<Key> keys;
+  for (Sight* s : sights) {
+    Key key = {s->m_GeometryId, s->m_Colour.GetRGBA()};
+    keys.push_back(key);
+  }
+  if (!(keys == m_Keys) || band != m_Band) {
+    Build(sights, band);
+    m_Keys.swap(keys);
+    m_Band = band;
+  }
+
+  glEnable(GL_BLEND);
+
+  /* near the antimeridian the world to either side is also in view */
+  double span = hypot(VP.pix_width, VP.pix_height) / 2 / scale;
+  float linewidth = wxMax(1.0, floor(0.5 * pix_per_mm));
+  float transform[16] = {0};
+  transform[0] = ax;
+  transform[1] = ay;
+  transform[4] = bx;
+  transform[5] = by;
+  transform[10] = 1;
+  transform[15] = 1;
+  for (int k = -1; k <= 1 && !m_Vertices.empty(); k++) {
+    double offset = 360 * k;
+    if (offset + 225 < VP.clon - span || offset - 225 > VP.clon + span)
+      continue;
+
+    transform[12] = s0.m_x + ax * (offset - VP.clon) - bx * y0;
+    transform[13] = s0.m_y + ay * (offset - VP.clon) - by * y0;
+    Draw(transform, linewidth);
+  }
+
+#ifdef USE_ANDROID_GLES2
+  transform[12] = s0.m_x - ax * VP.clon - bx * y0;
+  transform[13] = s0.m_y - ay * VP.clon - by * y0;
+  DrawBands(sights, transform, linewidth, scale, VP.clon - span,
+            VP.clon + span);
+#endif
+
+  glDisable(GL_BLEND);
+  return true;
+}
+
+void SightRenderer::Draw(float transform[16], float linewidth) {
+#ifdef USE_ANDROID_GLES2
+  if (!m_Buffer) glGenBuffers(1, &m_Buffer);
+  glBindBuffer(GL_ARRAY_BUFFER, m_Buffer);
+  if (!m_bUploaded) {
+    glBufferData(GL_ARRAY_BUFFER, m_Vertices.size() * sizeof(Vertex),
+                 &m_Vertices[0], GL_STATIC_DRAW);
+    m_bUploaded = true;
+  }
+
+  GLint program = pi_colorv_tri_shader_program;
+  glUseProgram(program);
+
+  GLint pos = glGetAttribLocation(program, "position");
+  glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                        (GLvoid*)offsetof(Vertex, x));
+  glEnableVertexAttribArray(pos);
+  GLint colorv = glGetAttribLocation(program, "colorv");
+  glVertexAttribPointer(colorv, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+                        (GLvoid*)offsetof(Vertex, rgba));
+  glEnableVertexAttribArray(colorv);
+
+  GLint matloc = glGetUniformLocation(program, "TransformMatrix");
+  glUniformMatrix4fv(matloc, 1, GL_FALSE, transform);
+
+  glDrawArrays(GL_TRIANGLES, 0, m_TriangleVertices);
+  glLineWidth(linewidth);
+  glDrawArrays(GL_LINES, m_TriangleVertices, m_LineVertices);
+
+  // Restore the per-object transform to Identity Matrix
+  mat4x4 I;
+  mat4x4_identity(I);
+  glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat*)I);
+
+  glDisableVertexAttribArray(pos);
+  glDisableVertexAttribArray(colorv);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glUseProgram(0);
+#else
+  /* client side arrays, buffer objects need an extension loader on some
+     desktop platforms */
+  glPushMatrix();
+  glMultMatrixf(transform);
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_COLOR_ARRAY);
+  glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &m_Vertices[0].x);
+  glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), m_Vertices[0].rgba);
+
+  glDrawArrays(GL_TRIANGLES, 0, m_TriangleVertices);
+  glLineWidth(linewidth);
+  glDrawArrays(GL_LINES, m_TriangleVertices, m_LineVertices);
+
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glPopMatrix();
+#endif
+}
+
+#ifdef USE_ANDROID_GLES2
+/* an altitude sight is its circles of equal altitude unless its points
+   were shifted */
+bool SightRenderer::Analytic(const Sight* s) {
+  return s->m_Type == Sight::ALTITUDE && !s->m_ShiftNm &&
+         !s->m_BandCenters.empty() &&
+         fabs(s->m_ObservedAltitude) + s->m_MeasurementCertainty / 60 <= 90;
+}
+
+/* the quads are clipped to the longitudes in view, lonmin to lonmax, and
+   repeated a world away where they reach past the antimeridian */
+void SightRenderer::DrawBands(const std::vector<Sight*>& sights,
+                              float transform[16], float linewidth,
+                              double pix_per_degree, double lonmin,
+                              double lonmax) {
+  GLint program = pi_altitude_band_shader_program;
+  glUseProgram(program);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  GLint matloc = glGetUniformLocation(program, "TransformMatrix");
+  glUniformMatrix4fv(matloc, 1, GL_FALSE, transform);
+  glUniform1f(glGetUniformLocation(program, "halfline"), linewidth / 2);
+  glUniform1f(glGetUniformLocation(program, "pixel"),
+              d_to_r(1 / pix_per_degree));
+  GLint gploc = glGetUniformLocation(program, "gp");
+  GLint radiusloc = glGetUniformLocation(program, "radius");
+  GLint widthloc = glGetUniformLocation(program, "halfwidth");
+  GLint colorloc = glGetUniformLocation(program, "color");
+
+  GLint pos = glGetAttribLocation(program, "position");
+  float coords[8];
+  glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), coords);
+  glEnableVertexAttribArray(pos);
+
+  /* a couple of pixels around the polygons covers the antialiased edges */
+  double pad = 2 / pix_per_degree;
+  for (Sight* s : sights) {
+    if (!Analytic(s)) continue;
+
+    /* the quad covers the extent of the polygons the sight would have, all
+       the way around if that is what they span */
+    const SightExtent& e = s->m_Extent;
+    double x0 = resolve_heading(e.m_LonMin) - pad;
+    double x1 = x0 + e.m_LonSpan + 2 * pad;
+    if (x1 - x0 >= 360) x0 += pad, x1 = x0 + 360;
+    coords[1] = coords[3] = MercatorY(e.m_LatMin - pad);
+    coords[5] = coords[7] = MercatorY(e.m_LatMax + pad);
+
+    float color[4] = {s->m_Colour.Red() / 255.0f, s->m_Colour.Green() / 255.0f,
+                      s->m_Colour.Blue() / 255.0f,
+                      s->m_Colour.Alpha() / 255.0f};
+    glUniform4fv(colorloc, 1, color);
+    glUniform1f(radiusloc, d_to_r(90 - s->m_ObservedAltitude));
+    glUniform1f(widthloc, d_to_r(s->m_MeasurementCertainty / 60));
+
+    for (int k = -1; k <= 1; k++) {
+      double l0 = wxMax(x0 + 360 * k, lonmin), l1 = wxMin(x1 + 360 * k, lonmax);
+      if (l0 >= l1) continue;
+      coords[0] = coords[4] = l0;
+      coords[2] = coords[6] = l1;
+      for (const wxRealPoint& gp : s->m_BandCenters) {
+        glUniform2f(gploc, d_to_r(gp.x), d_to_r(gp.y));
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+      }
+    }
+  }
+
+  // Restore the per-object transform to Identity Matrix
+  mat4x4 I;
+  mat4x4_identity(I);
+  glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat*)I);
+
+  glDisableVertexAttribArray(pos);
+  glUseProgram(0);
+}
+#endif
@@ -0,0 +1,86 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#ifndef _SIGHTRENDERER_H_
+#define _SIGHTRENDERER_H_
+
+#include <vector>
+
+#include "pidc.h"
+
+class Sight;
+
+/* Draws all the sights on a GL canvas in a few calls.  Vertices are kept in
+   mercator world coordinates (longitude and mercator latitude in degrees)
+   with a colour each, so they only change with the sights themselves, and
+   the viewport is applied as a transform when drawing.  On GLES2 altitude
+   sights skip the vertices, a shader draws their bands directly from the
+   body position over a quad covering each. */
+class SightRenderer {
+public:
+  SightRenderer();
+  ~SightRenderer();
+
+  /* draw the sights, false if the viewport is not a mercator projection, in
+     which case the caller should render each sight itself */
+  bool Render(const std::vector<Sight*>& sights, PlugIn_ViewPort& VP,
+              double pix_per_mm);
+
+private:
+  struct Vertex {
+    float x, y;
+    unsigned char rgba[4];
+  };
+
+  /* what the vertices were built from: geometry and colour of each sight */
+  struct Key {
+    unsigned int geometry;
+    wxUint32 colour;
+    bool operator==(const Key& k) const {
+      return geometry == k.geometry && colour == k.colour;
+    }
+  };
+
+  void Build(const std::vector<Sight*>& sights, int band);
+  void Draw(float transform[16], float linewidth);
+
+  std::vector<Key> m_Keys;
+  int m_Band;  // zoom band the geometry was simplified for
+  std::vector<Vertex> m_Vertices;  // triangles followed by line segments
+  size_t m_TriangleVertices, m_LineVertices;
+
+#ifdef USE_ANDROID_GLES2
+  static bool Analytic(const Sight* s);
+  void DrawBands(const std::vector<Sight*>& sights, float transform[16],
+                 float linewidth, double pix_per_degree, double lonmin,
+                 double lonmax);
+
+  GLuint m_Buffer;
+  bool m_bUploaded;
+#endif
+};
+
+#endif
@@ -0,0 +1,77 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#include "SightWorkerPool.h"
+
+SightWorkerPool::SightWorkerPool() : m_Busy(0), m_bStop(false) {
+  unsigned int count = std::thread::hardware_concurrency();
+  if (count < 2) count = 2;
+
+  for (unsigned int i = 0; i < count; i++)
+    m_Threads.push_back(std::thread(&SightWorkerPool::Run, this));
+}
+
+SightWorkerPool::~SightWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_bStop = true;
+    m_Tasks.clear();
+  }
+  m_TaskReady.notify_all();
+
+  for (std::thread& t : m_Threads) t.join();
+}
+
+void SightWorkerPool::Submit(const std::function<void()>& task) {
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Tasks.push_back(task);
+  }
+  m_TaskReady.notify_one();
+}
+
+void SightWorkerPool::Wait() {
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_TasksDone.wait(lock, [this] { return m_Tasks.empty() && !m_Busy; });
+}
+
+void SightWorkerPool::Run() {
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  for (;;) {
+    m_TaskReady.wait(lock, [this] { return m_bStop || !m_Tasks.empty(); });
+    if (m_bStop) return;
+
+    std::function<void()> task = m_Tasks.front();
+    m_Tasks.pop_front();
+    m_Busy++;
+
+    lock.unlock();
+    task();
+    lock.lock();
+
+    if (--m_Busy == 0 && m_Tasks.empty()) m_TasksDone.notify_all();
+  }
+}
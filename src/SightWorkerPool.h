@@ -0,0 +1,59 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#ifndef _SIGHTWORKERPOOL_H_
+#define _SIGHTWORKERPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Fixed set of worker threads for sight computations, so the ephemeris and
+   line of position work of many sights runs in parallel instead of one after
+   another on the UI thread.  Tasks must only touch their own data. */
+class SightWorkerPool {
+public:
+  SightWorkerPool();
+  ~SightWorkerPool();
+
+  void Submit(const std::function<void()>& task);
+  void Wait();  // block until every submitted task has finished
+
+private:
+  void Run();
+
+  std::vector<std::thread> m_Threads;
+  std::deque<std::function<void()> > m_Tasks;
+  std::mutex m_Mutex;
+  std::condition_variable m_TaskReady, m_TasksDone;
+  int m_Busy;
+  bool m_bStop;
+};
+
+#endif  // _SIGHTWORKERPOOL_H_
@@ -0,0 +1,269 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include "TrackEstimator.h"
+#include "FixEngine.h"
+#include "Sight.h"
+#include "celestial_navigation_pi.h"
+
+/* random walk of the dead reckoning position, in nautical miles over the
+   root of an hour, from log and compass errors and leeway */
+static const double s_DRNoise = 1;
+
+/* random walk of the current, in knots over the root of an hour */
+static const double s_CurrentNoise = .2;
+
+/* knots the current is unknown to when it is first estimated */
+static const double s_CurrentStart = 2;
+
+/* seconds between samples of the track and of the distance run */
+static const double s_Interval = 60;
+
+/* innovations beyond this many standard deviations are blunders */
+static const double s_Gate = 5;
+
+TrackEstimator::TrackEstimator() : m_bStarted(false), m_Sights(0) {}
+
+void TrackEstimator::Start(double time, double lat, double lon, double sd) {
+  m_bStarted = true;
+  m_Time = time;
+  m_Lat = lat;
+  m_Lon = lon;
+  m_Current[0] = m_Current[1] = 0;
+  m_Heading = m_Speed = 0;
+  m_bGround = false;
+
+  /* the current starts unknown to a couple of knots */
+  memset(m_P, 0, sizeof m_P);
+  m_P[0][0] = m_P[1][1] = sd * sd;
+  m_P[2][2] = m_P[3][3] = s_CurrentStart * s_CurrentStart;
+
+  m_Run[0] = m_Run[1] = 0;
+  m_Log.clear();
+  Log log = {time, 0, 0};
+  m_Log.push_back(log);
+
+  m_Track.clear();
+  m_Sights = 0;
+  m_Seen.clear();
+  Record(true);
+}
+
+void TrackEstimator::Predict(double time) {
+  double dt = (time - m_Time) / 3600;
+  if (!(dt > 0)) return;
+
+  /* through the water by the log, and over the ground with the current */
+  double h = d_to_r(m_Heading);
+  double le = m_Speed * sin(h) * dt, ln = m_Speed * cos(h) * dt;
+  m_Run[0] += le, m_Run[1] += ln;
+  double east = le + m_Current[0] * dt, north = ln + m_Current[1] * dt;
+  m_Lat += north / 60;
+  m_Lon = resolve_heading(m_Lon + east / (60 * cos(d_to_r(m_Lat))));
+  m_Time = time;
+
+  /* P = F P Ft + Q, where F adds dt times the current to the position */
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 4; j++) m_P[i][j] += dt * m_P[i + 2][j];
+  for (int i = 0; i < 4; i++)
+    for (int j = 0; j < 2; j++) m_P[i][j] += dt * m_P[i][j + 2];
+  for (int i = 0; i < 2; i++) {
+    m_P[i][i] += s_DRNoise * s_DRNoise * dt;
+    if (!m_bGround) m_P[i + 2][i + 2] += s_CurrentNoise * s_CurrentNoise * dt;
+  }
+}
+
+void TrackEstimator::Record(bool always) {
+  if (!always && !m_Track.empty() &&
+      m_Time < m_Track.back().time + s_Interval)
+    return;
+
+  TrackPoint p;
+  p.time = m_Time;
+  p.lat = m_Lat;
+  p.lon = m_Lon;
+  for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 2; j++) p.C[i][j] = m_P[i][j];
+  m_Track.push_back(p);
+}
+
+void TrackEstimator::Motion(double time, double heading, double speed,
+                            bool ground) {
+  if (!m_bStarted) return;
+
+  Predict(time);
+  m_Heading = heading;
+  m_Speed = speed;
+
+  /* with no current and nothing known of it, the position and sights are
+     never moved by it */
+  if (ground != m_bGround) {
+    m_bGround = ground;
+    m_Current[0] = m_Current[1] = 0;
+    for (int i = 0; i < 4; i++)
+      for (int j = 2; j < 4; j++) m_P[i][j] = m_P[j][i] = 0;
+    if (!ground) m_P[2][2] = m_P[3][3] = s_CurrentStart * s_CurrentStart;
+  }
+
+  if (m_Time >= m_Log.back().time + s_Interval) {
+    Log log = {m_Time, m_Run[0], m_Run[1]};
+    m_Log.push_back(log);
+  }
+  Record(false);
+}
+
+/* distance run through the water by time, interpolated between the
+   samples, and from the start for earlier times */
+void TrackEstimator::Run(double time, double& east, double& north) const {
+  Log now = {m_Time, m_Run[0], m_Run[1]};
+  auto it = std::upper_bound(
+      m_Log.begin(), m_Log.end(), time,
+      [](double t, const Log& log) { return t < log.time; });
+  if (it == m_Log.begin()) {
+    east = north = 0;
+    return;
+  }
+
+  const Log& a = *(it - 1);
+  const Log& b = it == m_Log.end() ? now : *it;
+  double f = b.time > a.time ? (time - a.time) / (b.time - a.time) : 0;
+  f = wxMax(0.0, wxMin(1.0, f));
+  east = a.east + f * (b.east - a.east);
+  north = a.north + f * (b.north - a.north);
+}
+
+bool TrackEstimator::Altitude(double time, double gplat, double gplon,
+                              double altitude, double sd) {
+  /* the distance run is only known from the start */
+  if (!m_bStarted || time < m_Log.front().time) return false;
+
+  /* a sight after the dead reckoning carries it on, one before is taken
+     where the boat was, back by the distance run and the current since */
+  if (time > m_Time) Predict(time);
+  double dt = (m_Time - time) / 3600;
+  double rune, runn;
+  Run(time, rune, runn);
+  double east = -(m_Run[0] - rune + m_Current[0] * dt);
+  double north = -(m_Run[1] - runn + m_Current[1] * dt);
+  double lat = m_Lat + north / 60;
+  double lon = m_Lon + east / (60 * cos(d_to_r(lat)));
+
+  /* computed altitude and azimuth there */
+  double slat = sin(d_to_r(lat)), clat = cos(d_to_r(lat));
+  double sdec = sin(d_to_r(gplat)), cdec = cos(d_to_r(gplat));
+  double lha = d_to_r(lon - gplon);
+  double hc = r_to_d(asin(wxMax(
+      -1.0, wxMin(1.0, slat * sdec + clat * cdec * cos(lha)))));
+  double zn = atan2(-cdec * sin(lha), clat * sdec - slat * cdec * cos(lha));
+
+  /* the altitude grows a minute for each mile toward the body, then the
+     current moves the earlier position back by dt for each knot */
+  double H[4] = {sin(zn), cos(zn), -dt * sin(zn), -dt * cos(zn)};
+  double y = (altitude - hc) * 60;
+
+  /* the dead reckoning between the sight and now is not in P */
+  double R = sd * sd + s_DRNoise * s_DRNoise * dt;
+  double PH[4], S = R;
+  for (int i = 0; i < 4; i++) {
+    PH[i] = 0;
+    for (int j = 0; j < 4; j++) PH[i] += m_P[i][j] * H[j];
+    S += H[i] * PH[i];
+  }
+  if (y * y > s_Gate * s_Gate * S) return false;
+
+  double K[4];
+  for (int i = 0; i < 4; i++) K[i] = PH[i] / S;
+  m_Lat += K[1] * y / 60;
+  m_Lon = resolve_heading(m_Lon + K[0] * y / (60 * cos(d_to_r(m_Lat))));
+  m_Current[0] += K[2] * y;
+  m_Current[1] += K[3] * y;
+
+  /* P - K S Kt, kept symmetric */
+  for (int i = 0; i < 4; i++)
+    for (int j = i; j < 4; j++)
+      m_P[i][j] = m_P[j][i] = m_P[i][j] - K[i] * S * K[j];
+
+  m_Sights++;
+  Record(true);
+  return true;
+}
+
+int TrackEstimator::Update(std::vector<Sight>& sights, int clock_offset) {
+  if (!m_bStarted) return 0;
+
+  /* sights turned away are tried again, as the estimate may come to them */
+  struct Fresh {
+    double time;
+    Sight* sight;
+    Key key;
+    bool operator<(const Fresh& f) const { return time < f.time; }
+  };
+  std::vector<Fresh> fresh;
+  for (Sight& s : sights) {
+    if (!s.IsVisible() || s.m_Type != Sight::ALTITUDE) continue;
+    wxDateTime time = s.m_DateTime + wxTimeSpan::Seconds(clock_offset);
+    Key key = std::make_tuple(s.m_Body.ToStdWstring(),
+                              (long long)time.GetValue().GetValue(),
+                              s.m_ObservedAltitude);
+    if (m_Seen.count(key)) continue;
+    wxDateTime utc = time;
+    utc.MakeFromUTC();
+    Fresh f = {(double)utc.GetTicks(), &s, key};
+    fresh.push_back(f);
+  }
+  std::stable_sort(fresh.begin(), fresh.end());
+
+  int used = 0;
+  for (Fresh& f : fresh) {
+    Sight& s = *f.sight;
+    wxDateTime time = s.m_DateTime + wxTimeSpan::Seconds(clock_offset);
+    double gplat, gplon, rate, decrate;
+    s.BodyLocation(time, &gplat, &gplon, 0, 0, 0);
+
+    /* an error in the time moves the body along its path, in minutes of
+       arc */
+    FixEngine::Rates(s, time, rate, decrate);
+    double st = s.m_TimeCertainty / 60 *
+                hypot(rate * cos(d_to_r(gplat)), decrate);
+    double sd = sqrt(s.m_MeasurementCertainty * s.m_MeasurementCertainty +
+                     st * st);
+    if (Altitude(f.time, gplat, gplon, s.m_ObservedAltitude,
+                 wxMax(sd, .1))) {
+      m_Seen.insert(f.key);
+      used++;
+    }
+  }
+  return used;
+}
@@ -0,0 +1,114 @@
+/******************************************************************************
+ *
+ * Project:  OpenCPN
+ * Purpose:  Celestial Navigation Support
+ *
+ ***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************
+ *
+ */
+
+#ifndef _TRACKESTIMATOR_H_
+#define _TRACKESTIMATOR_H_
+
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+class Sight;
+
+/* the estimated position at a time, with the covariance in square
+   nautical miles of its east and north errors */
+struct TrackPoint {
+  double time;  // seconds since 1970
+  double lat, lon;
+  double C[2][2];
+};
+
+/* Extended Kalman filter following the boat over a passage.  The state is
+   the position and the current, which the log and compass don't see, and
+   it moves by dead reckoning between sights.  Each sight is one altitude
+   measurement folded into the state in constant time, sights taken
+   before the latest dead reckoning are related to the present through the
+   distance the log has run since, so history is never solved again */
+class TrackEstimator {
+public:
+  TrackEstimator();
+
+  /* forget everything and start at lat, lon, known to sd nautical miles */
+  void Start(double time, double lat, double lon, double sd);
+  bool IsStarted() const { return m_bStarted; }
+
+  /* from time on the boat makes speed knots heading true heading, through
+     the water, or over the ground when ground is set.  Motion over the
+     ground already has the current in it, so the current is then held at
+     zero and only estimated again once motion through the water returns */
+  void Motion(double time, double heading, double speed, bool ground);
+
+  /* an altitude observed at time of a body with geographic position
+     gplat, gplon, certain to sd minutes of arc.  False before Start, for
+     a sight taken before the start, or if it is so far from the estimate
+     it is taken for a blunder */
+  bool Altitude(double time, double gplat, double gplon, double altitude,
+                double sd);
+
+  /* feed the visible altitude sights not used before, oldest first.
+     Returns how many were used */
+  int Update(std::vector<Sight>& sights, int clock_offset);
+
+  /* the estimate over time, a point a minute and one at each sight */
+  const std::vector<TrackPoint>& Track() const { return m_Track; }
+  int Sights() const { return m_Sights; }
+
+  /* estimated current in knots */
+  double CurrentEast() const { return m_Current[0]; }
+  double CurrentNorth() const { return m_Current[1]; }
+
+private:
+  void Predict(double time);
+  void Record(bool always);
+  void Run(double time, double& east, double& north) const;
+
+  bool m_bStarted;
+  double m_Time, m_Lat, m_Lon;
+  double m_Current[2];  // east and north knots
+  /* covariance of the east and north position errors in nautical miles,
+     then of the current in knots */
+  double m_P[4][4];
+  double m_Heading, m_Speed;
+  bool m_bGround;
+
+  /* distance run through the water (or over the ground) east and north in
+     nautical miles since the start, now and sampled a minute apart */
+  struct Log {
+    double time, east, north;
+  };
+  double m_Run[2];
+  std::vector<Log> m_Log;
+
+  std::vector<TrackPoint> m_Track;
+  int m_Sights;
+
+  /* body, time and altitude of the sights already used */
+  typedef std::tuple<std::wstring, long long, double> Key;
+  std::set<Key> m_Seen;
+};
+
+#endif  // _TRACKESTIMATOR_H_
@@ -31,6 +31,10 @@
 #endif  // precompiled headers
 
 #include <wx/stdpaths.h>
+#include <wx/thread.h>
+
+#include <chrono>
+#include <mutex>
 
 #include "ocpn_plugin.h"
 
@@ -38,9 +42,6 @@
 #include "CelestialNavigationDialog.h"
 #include "Sight.h"
 #include "icons.h"
-#include <wx/jsonreader.h>
-#include <wx/jsonwriter.h>
-#include <wx/jsonval.h>
 
 using namespace std;
 
@@ -119,12 +120,15 @@ int celestial_navigation_pi::Init(void) {
 #endif
 
   m_pCelestialNavigationDialog = NULL;
+  m_pdc = NULL;
+  m_pGLdc = NULL;
+  m_pGLContext = NULL;
+  m_view_scale_ppm = 0;
+  m_ClickSight = -1;
 
   return (WANTS_OVERLAY_CALLBACK | WANTS_OPENGL_OVERLAY_CALLBACK |
-          WANTS_NMEA_EVENTS |
-          //            WANTS_CURSOR_LATLON       |
-          WANTS_TOOLBAR_CALLBACK | WANTS_PLUGIN_MESSAGING |
-          INSTALLS_TOOLBAR_TOOL);
+          WANTS_NMEA_EVENTS | WANTS_CURSOR_LATLON | WANTS_MOUSE_EVENTS |
+          WANTS_TOOLBAR_CALLBACK | INSTALLS_TOOLBAR_TOOL);
 }
 
 bool celestial_navigation_pi::DeInit(void) {
@@ -135,6 +139,12 @@ bool celestial_navigation_pi::DeInit(void) {
     delete m_pCelestialNavigationDialog;
     m_pCelestialNavigationDialog = NULL;
   }
+
+  delete m_pdc;
+  m_pdc = NULL;
+  delete m_pGLdc;
+  m_pGLdc = NULL;
+  m_pGLContext = NULL;
   return true;
 }
 
@@ -225,54 +235,250 @@ void celestial_navigation_pi::SetColorScheme(PI_ColorScheme cs) {
   DimeWindow(m_pCelestialNavigationDialog);
 }
 
+/* the drawing contexts live as long as the plugin, only the target dc or
+   viewport is rebound each frame */
 bool celestial_navigation_pi::RenderOverlay(wxDC& dc, PlugIn_ViewPort* vp) {
-  piDC* pidc = new piDC(dc);
-  bool ret = RenderOverlayAll(pidc, vp);
-  delete pidc;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  if (!m_pdc) m_pdc = new piDC();
+  m_pdc->SetDC(&dc);
+  long setupus = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start).count();
+
+  bool ret = RenderOverlayAll(m_pdc, vp);
+  if (m_pCelestialNavigationDialog)
+    m_pCelestialNavigationDialog->m_RenderStats.setupus = setupus;
+  m_pdc->SetDC(NULL);
   return ret;
 }
 
 bool celestial_navigation_pi::RenderGLOverlay(wxGLContext* pcontext,
                                               PlugIn_ViewPort* vp) {
-  piDC* pidc = new piDC(pcontext);
-  pidc->SetVP(vp);
-  bool ret = RenderOverlayAll(pidc, vp);
-  delete pidc;
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  if (m_pGLdc && m_pGLContext != pcontext) {
+    delete m_pGLdc;
+    m_pGLdc = NULL;
+  }
+  if (!m_pGLdc) {
+    m_pGLdc = new piDC(pcontext);
+    m_pGLContext = pcontext;
+  }
+  m_pGLdc->SetVP(vp);
+  long setupus = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start).count();
+
+  bool ret = RenderOverlayAll(m_pGLdc, vp);
+  if (m_pCelestialNavigationDialog)
+    m_pCelestialNavigationDialog->m_RenderStats.setupus = setupus;
   return ret;
 }
 
+/* an error ellipse about lat, lon with semi-axes in nautical miles, the
+   major toward the true bearing */
+static void DrawEllipse(piDC* dc, PlugIn_ViewPort* vp, double lat, double lon,
+                        double major, double minor, double bearing) {
+  const int n = 64;
+  wxPoint points[n + 1];
+  double b = d_to_r(bearing);
+  for (int i = 0; i <= n; i++) {
+    double t = d_to_r(360.0 * i / n);
+    double a = major * cos(t), c = minor * sin(t);
+    double north = a * cos(b) - c * sin(b);
+    double east = a * sin(b) + c * cos(b);
+    GetCanvasPixLL(vp, &points[i], lat + north / 60,
+                   lon + east / (60 * cos(d_to_r(lat))));
+  }
+  dc->DrawLines(n + 1, points);
+}
+
 bool celestial_navigation_pi::RenderOverlayAll(piDC* dc, PlugIn_ViewPort* vp) {
   if (!m_pCelestialNavigationDialog || !m_pCelestialNavigationDialog->IsShown())
     return false;
 
-  /* draw sights */
-  for (Sight& s : m_pCelestialNavigationDialog->m_Sights) {
-    s.Render(dc, *vp, m_pCelestialNavigationDialog->m_pix_per_mm);
+  std::vector<Sight*> sights;
+  for (Sight& s : m_pCelestialNavigationDialog->m_Sights)
+    if (s.IsVisible()) sights.push_back(&s);
+  Sight* preview = m_pCelestialNavigationDialog->m_PreviewSight;
+  if (preview && preview->IsVisible()) sights.push_back(preview);
+
+  /* the residuals of the fix go under the sights */
+  FixDialog* fix = m_pCelestialNavigationDialog->m_FixDialog;
+  if (fix && fix->IsShown() && !fix->m_MapContributions.empty())
+    m_ResidualMap.Render(dc, *vp, fix->m_MapContributions);
+
+  /* draw sights through the offscreen image where there is one, so pans
+     only move it */
+  double pix_per_mm = m_pCelestialNavigationDialog->m_pix_per_mm;
+  SightRenderStats& stats = m_pCelestialNavigationDialog->m_RenderStats;
+  stats = SightRenderStats();
+  if (!m_OverlayCache.Render(
+          dc, *vp, sights, pix_per_mm,
+          [&](piDC* pdc, PlugIn_ViewPort& pvp) {
+            RenderSights(pdc, pvp, sights, pix_per_mm);
+          },
+          &stats.cached))
+    RenderSights(dc, *vp, sights, pix_per_mm);
+
+  m_view_scale_ppm = vp->view_scale_ppm;
+  if (!m_HoverSights.empty()) RenderHover(dc, vp);
+  if (m_TrackEstimator.Sights()) RenderTrack(dc, vp);
+
+  if (!fix || !fix->IsShown()) return true;
+
+  if (!fix->m_FixSimulation.Points().empty())
+    RenderFixSimulation(dc, vp, fix->m_FixSimulation);
+
+  /* other places the sights fit, as small crosses */
+  dc->SetPen(wxPen(wxColor(255, 0, 0), (int)wxMax(0.3 * pix_per_mm, 1.0)));
+  int candidatelen = (int)(3.0 * pix_per_mm);
+  for (const FixEngine::Candidate& c : fix->m_Candidates) {
+    if (fix->IsFix(c)) continue;
+    wxPoint r;
+    GetCanvasPixLL(vp, &r, c.lat, c.lon);
+    dc->DrawLine(r.x - candidatelen, r.y - candidatelen, r.x + candidatelen,
+                 r.y + candidatelen);
+    dc->DrawLine(r.x - candidatelen, r.y + candidatelen, r.x + candidatelen,
+                 r.y - candidatelen);
   }
 
-  if (!m_pCelestialNavigationDialog->m_FixDialog ||
-      !m_pCelestialNavigationDialog->m_FixDialog->IsShown())
-    return true;
+  /* the cocked hat, and the largest circle inside it */
+  const std::vector<wxRealPoint>& hat = fix->m_CockedHat.Hat();
+  if (hat.size() > 1) {
+    std::vector<wxPoint> points(hat.size());
+    for (size_t i = 0; i < hat.size(); i++)
+      GetCanvasPixLL(vp, &points[i], hat[i].x, hat[i].y);
+    dc->SetPen(wxPen(wxColor(255, 0, 0), (int)wxMax(0.3 * pix_per_mm, 1.0)));
+    dc->SetBrush(wxBrush(wxColour(255, 0, 0, 48)));
+    dc->DrawPolygon(points.size(), &points[0]);
+
+    double ilat, ilon, radius;
+    if (fix->m_CockedHat.Inscribed(ilat, ilon, radius)) {
+      dc->SetBrush(*wxTRANSPARENT_BRUSH);
+      DrawEllipse(dc, vp, ilat, ilon, radius, radius, 0);
+    }
+  }
 
-  /* now render fix */
-  double lat = m_pCelestialNavigationDialog->m_FixDialog->m_fixlat;
-  double lon = m_pCelestialNavigationDialog->m_FixDialog->m_fixlon;
-  double err = m_pCelestialNavigationDialog->m_FixDialog->m_fixerror;
+  /* now render fix, as its error ellipse where the certainties give one */
+  double lat = fix->m_fixlat;
+  double lon = fix->m_fixlon;
+  double err = fix->m_fixerror;
 
   if (!isnan(err)) {
     wxPoint r;
     GetCanvasPixLL(vp, &r, lat, lon);
-    int crosslen = (int) ( 10.0 * m_pCelestialNavigationDialog->m_pix_per_mm);
 
-    dc->SetPen(wxPen(wxColor(255, 0, 0),
-                     (int)(0.5 * m_pCelestialNavigationDialog->m_pix_per_mm)));
+    dc->SetPen(wxPen(wxColor(255, 0, 0), (int)(0.5 * pix_per_mm)));
     dc->SetBrush(*wxTRANSPARENT_BRUSH);
-    dc->DrawLine(r.x - crosslen, r.y - crosslen, r.x + crosslen, r.y + crosslen);
-    dc->DrawLine(r.x - crosslen, r.y + crosslen, r.x + crosslen, r.y - crosslen);
+    if (!isnan(fix->m_fixmajor)) {
+      DrawEllipse(dc, vp, lat, lon, fix->m_fixmajor, fix->m_fixminor,
+                  fix->m_fixbearing);
+      dc->DrawCircle(r, (int)wxMax(pix_per_mm, 1.0));
+    } else {
+      int crosslen = (int)(10.0 * pix_per_mm);
+      dc->DrawLine(r.x - crosslen, r.y - crosslen, r.x + crosslen,
+                   r.y + crosslen);
+      dc->DrawLine(r.x - crosslen, r.y + crosslen, r.x + crosslen,
+                   r.y - crosslen);
+    }
   }
   return true;
 }
 
+/* draw sights, on GL all in one batch when the viewport allows, otherwise
+   one by one skipping those outside the viewport */
+void celestial_navigation_pi::RenderSights(piDC* dc, PlugIn_ViewPort& vp,
+                                           const std::vector<Sight*>& sights,
+                                           double pix_per_mm) {
+  SightRenderStats& stats = m_pCelestialNavigationDialog->m_RenderStats;
+  if (!dc->GetDC() && m_SightRenderer.Render(sights, vp, pix_per_mm))
+    stats.sights = sights.size();
+  else
+    for (Sight* s : sights) s->Render(dc, vp, pix_per_mm, &stats);
+}
+
+/* the estimated track since the first sight, and the 95% ellipse of the
+   latest estimate */
+void celestial_navigation_pi::RenderTrack(piDC* dc, PlugIn_ViewPort* vp) {
+  const std::vector<TrackPoint>& track = m_TrackEstimator.Track();
+  double pix_per_mm = m_pCelestialNavigationDialog->m_pix_per_mm;
+  dc->SetPen(wxPen(wxColour(0, 0, 160), (int)wxMax(0.4 * pix_per_mm, 1.0)));
+  dc->SetBrush(*wxTRANSPARENT_BRUSH);
+
+  std::vector<wxPoint> points(track.size());
+  for (size_t i = 0; i < track.size(); i++)
+    GetCanvasPixLL(vp, &points[i], track[i].lat, track[i].lon);
+  if (points.size() > 1) dc->DrawLines(points.size(), &points[0]);
+
+  const TrackPoint& p = track.back();
+  double major, minor, bearing;
+  FixEngine::Ellipse(p.C, .95, major, minor, bearing);
+  DrawEllipse(dc, vp, p.lat, p.lon, major, minor, bearing);
+}
+
+/* each monte carlo sample of the fix as a dot, and the ellipse holding 95%
+   of them */
+void celestial_navigation_pi::RenderFixSimulation(
+    piDC* dc, PlugIn_ViewPort* vp, const FixSimulation& simulation) {
+  double pix_per_mm = m_pCelestialNavigationDialog->m_pix_per_mm;
+  int size = (int)wxMax(0.5 * pix_per_mm, 2.0);
+  dc->SetPen(*wxTRANSPARENT_PEN);
+  dc->SetBrush(wxBrush(wxColour(255, 128, 0, 128)));
+  for (const wxRealPoint& p : simulation.Points()) {
+    if (std::isnan(p.x)) continue;
+    wxPoint r;
+    GetCanvasPixLL(vp, &r, p.x, p.y);
+    dc->DrawRectangle(r.x - size / 2, r.y - size / 2, size, size);
+  }
+
+  double lat, lon, C[2][2], major, minor, bearing;
+  if (!simulation.Spread(lat, lon, C)) return;
+  FixEngine::Ellipse(C, .95, major, minor, bearing);
+  dc->SetPen(wxPen(wxColour(255, 128, 0), (int)wxMax(0.4 * pix_per_mm, 1.0)));
+  dc->SetBrush(*wxTRANSPARENT_BRUSH);
+  DrawEllipse(dc, vp, lat, lon, major, minor, bearing);
+}
+
+void celestial_navigation_pi::UpdateTrack(std::vector<Sight>& sights,
+                                          int clock_offset) {
+  if (m_TrackEstimator.Update(sights, clock_offset))
+    RequestRefresh(m_parent_window);
+}
+
+/* names of the sights under the cursor in a box beside it */
+void celestial_navigation_pi::RenderHover(piDC* dc, PlugIn_ViewPort* vp) {
+  std::vector<Sight>& sights = m_pCelestialNavigationDialog->m_Sights;
+  wxArrayString lines;
+  for (int i : m_HoverSights) {
+    if (i >= (int)sights.size()) continue;
+    wxDateTime dt = sights[i].m_DateTime;
+    lines.Add(sights[i].m_Body + _T(" ") + dt.FormatISODate() + _T(" ") +
+              dt.FormatISOTime());
+  }
+  if (lines.empty()) return;
+
+  dc->SetFont(*GetOCPNScaledFont_PlugIn(_("Dialog")));
+  int w = 0, h = 0;
+  for (size_t i = 0; i < lines.size(); i++) {
+    int lw, lh;
+    dc->GetTextExtent(lines[i], &lw, &lh);
+    w = wxMax(w, lw);
+    h = wxMax(h, lh);
+  }
+
+  wxPoint r;
+  GetCanvasPixLL(vp, &r, m_HoverLat, m_HoverLon);
+  int margin = (int)(m_pCelestialNavigationDialog->m_pix_per_mm);
+  int x = r.x + 4 * margin, y = r.y + 4 * margin;
+
+  dc->SetPen(wxPen(wxColour(0, 0, 0), 1));
+  dc->SetBrush(wxBrush(wxColour(255, 255, 225)));
+  dc->DrawRectangle(x, y, w + 2 * margin, lines.size() * h + 2 * margin);
+  dc->SetTextForeground(wxColour(0, 0, 0));
+  for (size_t i = 0; i < lines.size(); i++)
+    dc->DrawText(lines[i], x + margin, y + margin + i * h);
+}
+
 wxString celestial_navigation_pi::StandardPath() {
   wxString stdPath(*GetpPrivateApplicationDataLocation());
   stdPath = stdPath + wxFileName::GetPathSeparator() + "plugins" +
@@ -282,33 +488,86 @@ wxString celestial_navigation_pi::StandardPath() {
 }
 
 static double s_boat_lat, s_boat_lon;
+/* nautical miles the position the track starts from is trusted to */
+static const double s_TrackStartCertainty = 30;
+
 void celestial_navigation_pi::SetPositionFixEx(PlugIn_Position_Fix_Ex& pfix) {
   s_boat_lat = pfix.Lat;
   s_boat_lon = pfix.Lon;
+
+  /* the track is carried on by heading and speed, the position only
+     starts it.  Speed is only had over the ground, which already has the
+     current in it, so the course over the ground goes with it */
+  double heading = isnan(pfix.Cog) ? pfix.Hdt : pfix.Cog;
+  if (isnan(heading) || isnan(pfix.Sog)) return;
+  if (!m_TrackEstimator.IsStarted()) {
+    if (isnan(pfix.Lat) || isnan(pfix.Lon)) return;
+    m_TrackEstimator.Start(pfix.FixTime, pfix.Lat, pfix.Lon,
+                           s_TrackStartCertainty);
+  }
+  m_TrackEstimator.Motion(pfix.FixTime, heading, pfix.Sog, true);
 }
 
-void celestial_navigation_pi::SetCursorLatLon(double lat, double lon) {}
+/* pixels from a line of position still counted as on it */
+static const double s_HitPixels = 4;
 
-void celestial_navigation_pi_BoatPos(double& lat, double& lon) {
-  lat = s_boat_lat;
-  lon = s_boat_lon;
+void celestial_navigation_pi::SetCursorLatLon(double lat, double lon) {
+  std::vector<int> hover;
+  if (m_pCelestialNavigationDialog && m_pCelestialNavigationDialog->IsShown() &&
+      m_view_scale_ppm > 0) {
+    m_SightIndex.Update(m_pCelestialNavigationDialog->m_Sights);
+    m_SightIndex.Find(lat, lon, s_HitPixels / (m_view_scale_ppm * 1852 * 60),
+                      hover);
+  }
+
+  /* the box stays where the cursor first found these sights, so the chart
+     is only redrawn when they change */
+  if (hover == m_HoverSights) return;
+  m_HoverSights.swap(hover);
+  m_HoverLat = lat;
+  m_HoverLon = lon;
+  RequestRefresh(m_parent_window);
 }
 
-double gQueryVar = 0;
+void celestial_navigation_pi::ClearHover() {
+  m_HoverSights.clear();
+  m_ClickSight = -1;
+}
 
-void celestial_navigation_pi::SetPluginMessage(wxString& message_id,
-                                               wxString& message_body) {
-  if (message_id == _T("WMM_VARIATION")) {
-    wxJSONValue root;
-    wxJSONReader reader;
-    if (reader.Parse(message_body, &root) > 0) return;
+/* pixels the mouse may move between press and release of a click, any
+   further and the chart is being dragged */
+static const int s_ClickPixels = 3;
 
-    wxString decl = root[_T("Decl")].AsString();
-    double decl_val;
-    decl.ToDouble(&decl_val);
+/* clicking on a line of position selects its sight in the list, double
+   clicking edits it */
+bool celestial_navigation_pi::MouseEventHook(wxMouseEvent& event) {
+  int clicked = m_ClickSight;
+  if (event.LeftDown() || event.LeftUp()) m_ClickSight = -1;
 
-    gQueryVar = decl_val;
+  if (m_HoverSights.empty() || !m_pCelestialNavigationDialog ||
+      !m_pCelestialNavigationDialog->IsShown())
+    return false;
+
+  int idx = m_HoverSights[0];
+  if (event.LeftDClick()) {
+    m_pCelestialNavigationDialog->CallAfter(
+        &CelestialNavigationDialog::EditSight, idx);
+    return true;
   }
+  if (event.LeftDown()) {
+    m_ClickSight = idx;
+    m_ClickPosition = event.GetPosition();
+  } else if (event.LeftUp() && clicked == idx) {
+    wxPoint d = event.GetPosition() - m_ClickPosition;
+    if (abs(d.x) <= s_ClickPixels && abs(d.y) <= s_ClickPixels)
+      m_pCelestialNavigationDialog->SelectSight(idx);
+  }
+  return false;
+}
+
+void celestial_navigation_pi_BoatPos(double& lat, double& lon) {
+  lat = s_boat_lat;
+  lon = s_boat_lon;
 }
 
 void celestial_navigation_pi::OnDialogClose() {
@@ -317,29 +576,20 @@ void celestial_navigation_pi::OnDialogClose() {
   m_pCelestialNavigationDialog = NULL;
 }
 
+/* the built in model keeps its state in globals */
+static std::mutex s_geomag_mutex;
+
+/* the variation comes from the built in model for every caller.  Sights are
+   computed on worker threads, which cannot ask the WMM plugin, and a sight
+   drawn from one source must agree with the same sight checked in the
+   dialog */
 double celestial_navigation_pi_GetWMM(double lat, double lon, double altitude,
                                       wxDateTime date) {
-  wxJSONValue v;
-  v[_T("Lat")] = lat;
-  v[_T("Lon")] = lon;
-  v[_T("Year")] = date.GetYear();
-  v[_T("Month")] = date.GetMonth();
-  v[_T("Day")] = date.GetDay();
-
-  wxJSONWriter w;
-  wxString out;
-  w.Write(v, out);
-
-  gQueryVar = 360;
-  SendPluginMessage(wxString(_T("WMM_VARIATION_REQUEST")), out);
-  if (gQueryVar == 360) {
-    double results[14];
-    geomag_calc(lat, lon, altitude / 1000, date.GetDay(), date.GetMonth(),
-                date.GetYear(), results);
-    return results[0];
-  }
-
-  return gQueryVar;
+  std::lock_guard<std::mutex> lock(s_geomag_mutex);
+  double results[14];
+  geomag_calc(lat, lon, altitude / 1000, date.GetDay(), date.GetMonth(),
+              date.GetYear(), results);
+  return results[0];
 }
 
 wxString celestial_navigation_pi_DataDir() {
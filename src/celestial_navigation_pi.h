@@ -35,6 +35,11 @@
 
 #include "ocpn_plugin.h"
 #include "pidc.h"
+#include "SightRenderer.h"
+#include "OverlayCache.h"
+#include "SightIndex.h"
+#include "TrackEstimator.h"
+#include "ResidualMap.h"
 
 //----------------------------------------------------------------------------------------------------------
 //    The PlugIn Class Definition
@@ -44,6 +49,7 @@
   -1  // Request default positioning of toolbar tool
 
 class CelestialNavigationDialog;
+class FixSimulation;
 
 class celestial_navigation_pi : public wxEvtHandler, opencpn_plugin_118 {
 public:
@@ -76,11 +82,24 @@ public:
   bool RenderOverlay(wxDC& dc, PlugIn_ViewPort* vp);
   bool RenderGLOverlay(wxGLContext* pcontext, PlugIn_ViewPort* vp);
   bool RenderOverlayAll(piDC* dc, PlugIn_ViewPort* vp);
+  void RenderSights(piDC* dc, PlugIn_ViewPort& vp,
+                    const std::vector<Sight*>& sights, double pix_per_mm);
+  void RenderHover(piDC* dc, PlugIn_ViewPort* vp);
+  void RenderTrack(piDC* dc, PlugIn_ViewPort* vp);
+  void RenderFixSimulation(piDC* dc, PlugIn_ViewPort* vp,
+                           const FixSimulation& simulation);
+
+  /* fold sights not seen before into the track estimate */
+  void UpdateTrack(std::vector<Sight>& sights, int clock_offset);
 
   static wxString StandardPath();
   void SetPositionFixEx(PlugIn_Position_Fix_Ex& pfix);
   void SetCursorLatLon(double lat, double lon);
-  void SetPluginMessage(wxString& message_id, wxString& message_body);
+  bool MouseEventHook(wxMouseEvent& event);
+
+  /* forget the sights under the cursor once the dialog's sights are
+     reordered or removed, until the cursor next moves */
+  void ClearHover();
   void OnDialogClose();
 
 private:
@@ -88,6 +107,28 @@ private:
   int m_leftclick_tool_id;
 
   CelestialNavigationDialog* m_pCelestialNavigationDialog;
+  SightRenderer m_SightRenderer;
+  OverlayCache m_OverlayCache;
+
+  /* sights under the cursor, as indices into the dialog's sights, and where
+     the cursor was when they were found */
+  SightIndex m_SightIndex;
+  std::vector<int> m_HoverSights;
+  double m_HoverLat, m_HoverLon;
+  double m_view_scale_ppm;  // of the last frame drawn, 0 before any
+
+  /* sight under the left button when it went down and where, -1 if none */
+  int m_ClickSight;
+  wxPoint m_ClickPosition;
+
+  /* track over the passage from the log and compass and the sights */
+  TrackEstimator m_TrackEstimator;
+
+  ResidualMap m_ResidualMap;
+
+  piDC* m_pdc;                // rebound to the wxDC of each frame
+  piDC* m_pGLdc;              // bound to m_pGLContext
+  wxGLContext* m_pGLContext;
 };
 
 extern void celestial_navigation_pi_BoatPos(double& lat, double& lon);
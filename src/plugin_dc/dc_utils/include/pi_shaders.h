@@ -39,6 +39,7 @@ extern GLint pi_texture_2D_shader_program;
 extern GLint pi_texture_2DA_shader_program;
 extern GLint pi_texture_text_shader_program;
 extern GLint pi_circle_filled_shader_program;
+extern GLint pi_altitude_band_shader_program;
 
 bool pi_loadShaders();
 void configureShaders(float width, float height);
@@ -139,6 +139,9 @@ public:
   void DrawEllipse(wxCoord x, wxCoord y, wxCoord width, wxCoord height);
   void DrawPolygon(int n, wxPoint points[], wxCoord xoffset = 0,
                    wxCoord yoffset = 0, float scale = 1.0, float angle = 0);
+  // Fill a strip of triangles alternating between the two sides of a band
+  // without tessellating it.  On a wxDC the band outline is filled.
+  void DrawTriangleStrip(int n, wxPoint points[]);
   void StrokePolygon(int n, wxPoint points[], wxCoord xoffset = 0,
                      wxCoord yoffset = 0, float scale = 1.0);
   void DrawPolygons(int n, int npoint[], wxPoint points[], wxCoord xoffset = 0,
@@ -213,6 +216,7 @@ public:
 
 #endif
   GLUtesselator *m_tobj;
+  GLUtesselator *m_tobjPolygon;  // reused by DrawPolygonTessellated
 
 protected:
   void DrawPolygonTessellatedPattern(int n, wxPoint points[], int textureID,
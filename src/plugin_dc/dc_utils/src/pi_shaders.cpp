@@ -186,6 +186,49 @@ static const GLchar* circle_filled_fragment_shader_source =
     "else { gl_FragColor = vec4(0.0, 0.0, 0.0, 0.0); }\n"
     "}\n";
 
+//  Altitude band shader, a circle of equal altitude around a geographic
+//  position drawn from mercator world coordinates (degrees of longitude
+//  and of mercator latitude)
+
+static const GLchar* altitude_band_vertex_shader_source =
+    "attribute vec2 position;\n"
+    "uniform mat4 MVMatrix;\n"
+    "uniform mat4 TransformMatrix;\n"
+    "varying vec2 world;\n"
+    "void main() {\n"
+    "   world = position;\n"
+    "   gl_Position = MVMatrix * TransformMatrix * vec4(position, 0.0, 1.0);\n"
+    "}\n";
+
+static const GLchar* altitude_band_fragment_shader_source =
+    "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+    "precision highp float;\n"
+    "#else\n"
+    "precision mediump float;\n"
+    "#endif\n"
+    "uniform vec2 gp;\n"           // radians of latitude and longitude
+    "uniform float radius;\n"      // zenith distance in radians
+    "uniform float halfwidth;\n"   // half the band width in radians
+    "uniform float halfline;\n"    // half the line width in pixels
+    "uniform float pixel;\n"       // radians of longitude per pixel
+    "uniform vec4 color;\n"
+    "varying vec2 world;\n"
+    "void main() {\n"
+    "   vec2 p = radians(world);\n"
+    "   float lat = 2.0 * atan(exp(p.y)) - 1.5707963;\n"
+    "   float a = sin((lat - gp.x) * 0.5);\n"
+    "   float b = sin((p.x - gp.y) * 0.5);\n"
+    "   float h = a * a + cos(lat) * cos(gp.x) * b * b;\n"
+    "   float d = 2.0 * asin(sqrt(clamp(h, 0.0, 1.0)));\n"
+    "   float px = max(pixel * cos(lat), 1e-7);\n"  // radians of arc
+    "   float off = abs(d - radius) / px;\n"
+    "   float band = clamp(halfwidth / px - off + 0.5, 0.0, 1.0);\n"
+    "   float line = clamp(halfline - off + 0.5, 0.0, 1.0);\n"
+    "   float alpha = 1.0 - (1.0 - color.a * band) * (1.0 - color.a * line);\n"
+    "   if (alpha <= 0.0) discard;\n"
+    "   gl_FragColor = vec4(color.rgb, alpha);\n"
+    "}\n";
+
 //  2D texture shader for FBOs
 static const GLchar* FBO_texture_2D_vertex_shader_source =
     "attribute vec2 aPos;\n"
@@ -233,6 +276,10 @@ GLint pi_circle_filled_shader_program;
 GLint pi_circle_filled_vertex_shader;
 GLint pi_circle_filled_fragment_shader;
 
+GLint pi_altitude_band_shader_program;
+GLint pi_altitude_band_vertex_shader;
+GLint pi_altitude_band_fragment_shader;
+
 //     GLint FBO_texture_2D_fragment_shader;
 //     GLint FBO_texture_2D_shader_program;
 //     GLint FBO_texture_2D_vertex_shader;
@@ -488,6 +535,56 @@ bool pi_loadShaders() {
     }
   }
 
+  // Altitude band shader
+
+  if (!pi_altitude_band_vertex_shader) {
+    /* Vertex shader */
+    pi_altitude_band_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(pi_altitude_band_vertex_shader, 1,
+                   &altitude_band_vertex_shader_source, NULL);
+    glCompileShader(pi_altitude_band_vertex_shader);
+    glGetShaderiv(pi_altitude_band_vertex_shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+      glGetShaderInfoLog(pi_altitude_band_vertex_shader, INFOLOG_LEN, NULL,
+                         infoLog);
+      printf("ERROR::SHADER::VERTEX::COMPILATION_FAILED\n%s\n", infoLog);
+      ret_val = false;
+    }
+  }
+
+  if (!pi_altitude_band_fragment_shader) {
+    /* Fragment shader */
+    pi_altitude_band_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(pi_altitude_band_fragment_shader, 1,
+                   &altitude_band_fragment_shader_source, NULL);
+    glCompileShader(pi_altitude_band_fragment_shader);
+    glGetShaderiv(pi_altitude_band_fragment_shader, GL_COMPILE_STATUS,
+                  &success);
+    if (!success) {
+      glGetShaderInfoLog(pi_altitude_band_fragment_shader, INFOLOG_LEN, NULL,
+                         infoLog);
+      printf("ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n%s\n", infoLog);
+      ret_val = false;
+    }
+  }
+
+  if (!pi_altitude_band_shader_program) {
+    /* Link shaders */
+    pi_altitude_band_shader_program = glCreateProgram();
+    glAttachShader(pi_altitude_band_shader_program,
+                   pi_altitude_band_vertex_shader);
+    glAttachShader(pi_altitude_band_shader_program,
+                   pi_altitude_band_fragment_shader);
+    glLinkProgram(pi_altitude_band_shader_program);
+    glGetProgramiv(pi_altitude_band_shader_program, GL_LINK_STATUS, &success);
+    if (!success) {
+      glGetProgramInfoLog(pi_altitude_band_shader_program, INFOLOG_LEN, NULL,
+                          infoLog);
+      printf("ERROR::SHADER::PROGRAM::LINKING_FAILED\n%s\n", infoLog);
+      ret_val = false;
+    }
+  }
+
 #if 0
     
     // Fade texture shader
@@ -692,6 +789,13 @@ void configureShaders(float width, float height) {
   transloc =
       glGetUniformLocation(pi_colorv_tri_shader_program, "TransformMatrix");
   glUniformMatrix4fv(transloc, 1, GL_FALSE, (const GLfloat*)I);
+
+  glUseProgram(pi_altitude_band_shader_program);
+  matloc = glGetUniformLocation(pi_altitude_band_shader_program, "MVMatrix");
+  glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat*)vp_transform);
+  transloc =
+      glGetUniformLocation(pi_altitude_band_shader_program, "TransformMatrix");
+  glUniformMatrix4fv(transloc, 1, GL_FALSE, (const GLfloat*)I);
 }
 #else
 bool pi_loadShaders() { return true; }
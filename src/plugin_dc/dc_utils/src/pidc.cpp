@@ -174,6 +174,11 @@ piDC::~piDC() {
   free(s_odc_tess_work_buf);
   free(s_odc_tess_tex_buf);
 #endif
+
+#ifdef ocpnUSE_GL
+  if (m_tobjPolygon) gluDeleteTess(m_tobjPolygon);
+#endif
+  free(workBuf);
 }
 
 void piDC::Init() {
@@ -206,6 +211,7 @@ void piDC::Init() {
 
   g_textureId = -1;
   m_tobj = NULL;
+  m_tobjPolygon = NULL;
 #ifdef ocpnUSE_GL
   if (glcontext) {
     GLint parms[2];
@@ -2086,6 +2092,77 @@ void piDC::DrawPolygon(int n, wxPoint points[], wxCoord xoffset,
 #endif  // ocpnUSE_GL
 }
 
+void piDC::DrawTriangleStrip(int n, wxPoint points[]) {
+  if (n < 3) return;
+
+  if (dc) {
+    // even points go along one side, odd points come back along the other
+    std::vector<wxPoint> outline;
+    outline.reserve(n);
+    for (int i = 0; i < n; i += 2) outline.push_back(points[i]);
+    for (int i = n - 1 - n % 2; i > 0; i -= 2) outline.push_back(points[i]);
+    dc->DrawPolygon(n, &outline[0]);
+  }
+#ifdef ocpnUSE_GL
+  else {
+    if (!ConfigureBrush()) return;
+
+    glEnable(GL_BLEND);
+
+#ifdef USE_ANDROID_GLES2
+    //  Grow the work buffer as necessary
+    if (workBufSize < (size_t)n * 2) {
+      workBuf = (float *)realloc(workBuf, (n * 4) * sizeof(float));
+      workBufSize = n * 4;
+    }
+
+    for (int i = 0; i < n; i++) {
+      workBuf[i * 2] = points[i].x;
+      workBuf[i * 2 + 1] = points[i].y;
+    }
+
+    GLint program = pi_color_tri_shader_program;
+    glUseProgram(program);
+
+    // Disable VBO's (vertex buffer objects) for attributes.
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    GLint pos = glGetAttribLocation(program, "position");
+    glVertexAttribPointer(pos, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float),
+                          workBuf);
+    glEnableVertexAttribArray(pos);
+
+    // Build Transform matrix
+    mat4x4 I;
+    mat4x4_identity(I);
+
+    GLint matloc = glGetUniformLocation(program, "TransformMatrix");
+    glUniformMatrix4fv(matloc, 1, GL_FALSE, (const GLfloat *)I);
+
+    float colorv[4];
+    wxColour c = GetBrush().GetColour();
+    colorv[0] = c.Red() / float(256);
+    colorv[1] = c.Green() / float(256);
+    colorv[2] = c.Blue() / float(256);
+    colorv[3] = c.Alpha() / float(256);
+    GLint colloc = glGetUniformLocation(program, "color");
+    glUniform4fv(colloc, 1, colorv);
+
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, n);
+
+    glUseProgram(0);
+#else
+    glBegin(GL_TRIANGLE_STRIP);
+    for (int i = 0; i < n; i++) glVertex2i(points[i].x, points[i].y);
+    glEnd();
+#endif
+
+    glDisable(GL_BLEND);
+  }
+#endif  // ocpnUSE_GL
+}
+
 void piDC::DrawPolygonPattern(int n, wxPoint points[], int textureID,
                               wxSize textureSize, wxCoord xoffset,
                               wxCoord yoffset, float scale, float angle) {
@@ -2408,21 +2485,25 @@ void piDC::DrawPolygonTessellated(int n, wxPoint points[], wxCoord xoffset,
 
 #ifdef USE_ANDROID_GLES2
 
-    m_tobj = gluNewTess();
-    s_odc_tess_vertex_idx = 0;
+    // The tessellator is kept for the life of the piDC
+    if (!m_tobjPolygon) {
+      m_tobjPolygon = gluNewTess();
 
-    gluTessCallback(m_tobj, GLU_TESS_VERTEX_DATA,
-                    (_GLUfuncptr)&odc_vertexCallbackD_GLSL);
-    gluTessCallback(m_tobj, GLU_TESS_BEGIN_DATA,
-                    (_GLUfuncptr)&odc_beginCallbackD_GLSL);
-    gluTessCallback(m_tobj, GLU_TESS_END_DATA,
-                    (_GLUfuncptr)&odc_endCallbackD_GLSL);
-    gluTessCallback(m_tobj, GLU_TESS_COMBINE_DATA,
-                    (_GLUfuncptr)&odc_combineCallbackD);
-    // s_tessVP = vp;
+      gluTessCallback(m_tobjPolygon, GLU_TESS_VERTEX_DATA,
+                      (_GLUfuncptr)&odc_vertexCallbackD_GLSL);
+      gluTessCallback(m_tobjPolygon, GLU_TESS_BEGIN_DATA,
+                      (_GLUfuncptr)&odc_beginCallbackD_GLSL);
+      gluTessCallback(m_tobjPolygon, GLU_TESS_END_DATA,
+                      (_GLUfuncptr)&odc_endCallbackD_GLSL);
+      gluTessCallback(m_tobjPolygon, GLU_TESS_COMBINE_DATA,
+                      (_GLUfuncptr)&odc_combineCallbackD);
 
-    gluTessNormal(m_tobj, 0, 0, 1);
-    gluTessProperty(m_tobj, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_NONZERO);
+      gluTessNormal(m_tobjPolygon, 0, 0, 1);
+      gluTessProperty(m_tobjPolygon, GLU_TESS_WINDING_RULE,
+                      GLU_TESS_WINDING_NONZERO);
+    }
+    m_tobj = m_tobjPolygon;
+    s_odc_tess_vertex_idx = 0;
 
     if (ConfigureBrush()) {
       gluTessBeginPolygon(m_tobj, this);
@@ -2475,7 +2556,6 @@ void piDC::DrawPolygonTessellated(int n, wxPoint points[], wxCoord xoffset,
       glDrawArrays(s_odc_tess_mode, 0, s_odc_nvertex);
     }
 
-    gluDeleteTess(m_tobj);
     m_tobj = NULL;
     glUseProgram(0);
 
@@ -2486,17 +2566,26 @@ void piDC::DrawPolygonTessellated(int n, wxPoint points[], wxCoord xoffset,
   }
 #else  // USE_ANDROID_GLES2
 
-    m_tobj = gluNewTess();
+    // The tessellator is kept for the life of the piDC
+    if (!m_tobjPolygon) {
+      m_tobjPolygon = gluNewTess();
 
-    gluTessCallback(m_tobj, GLU_TESS_VERTEX, (_GLUfuncptr)&piDCvertexCallback);
-    gluTessCallback(m_tobj, GLU_TESS_BEGIN, (_GLUfuncptr)&piDCbeginCallback);
-    gluTessCallback(m_tobj, GLU_TESS_END, (_GLUfuncptr)&piDCendCallback);
-    gluTessCallback(m_tobj, GLU_TESS_COMBINE,
-                    (_GLUfuncptr)&piDCcombineCallback);
-    gluTessCallback(m_tobj, GLU_TESS_ERROR, (_GLUfuncptr)&piDCerrorCallback);
+      gluTessCallback(m_tobjPolygon, GLU_TESS_VERTEX,
+                      (_GLUfuncptr)&piDCvertexCallback);
+      gluTessCallback(m_tobjPolygon, GLU_TESS_BEGIN,
+                      (_GLUfuncptr)&piDCbeginCallback);
+      gluTessCallback(m_tobjPolygon, GLU_TESS_END,
+                      (_GLUfuncptr)&piDCendCallback);
+      gluTessCallback(m_tobjPolygon, GLU_TESS_COMBINE,
+                      (_GLUfuncptr)&piDCcombineCallback);
+      gluTessCallback(m_tobjPolygon, GLU_TESS_ERROR,
+                      (_GLUfuncptr)&piDCerrorCallback);
 
-    gluTessNormal(m_tobj, 0, 0, 1);
-    gluTessProperty(m_tobj, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_NONZERO);
+      gluTessNormal(m_tobjPolygon, 0, 0, 1);
+      gluTessProperty(m_tobjPolygon, GLU_TESS_WINDING_RULE,
+                      GLU_TESS_WINDING_NONZERO);
+    }
+    m_tobj = m_tobjPolygon;
 
     if (ConfigureBrush()) {
       gluTessBeginPolygon(m_tobj, NULL);
@@ -2521,7 +2610,6 @@ void piDC::DrawPolygonTessellated(int n, wxPoint points[], wxCoord xoffset,
       delete (GLvertex *)pi_gTesselatorVertices[i];
     pi_gTesselatorVertices.Clear();
 
-    gluDeleteTess(m_tobj);
     m_tobj = NULL;
   }
 #endif
@@ -17,6 +17,8 @@
 #include <gtest/gtest.h>
 #include "ocpn_plugin.h"
 #include "Sight.h"
+#include "SightIndex.h"
+#include "celestial_navigation_pi.h"
 #include <cmath>
 #include <iomanip>
 #include <sstream>
@@ -947,3 +949,96 @@ TEST_F(AltitudeTest, DeriveHs) {
             << "Error differs from 0 by " << error;
     }
 }
+
+TEST(SightExtentTest, Antimeridian) {
+    SightExtent extent;
+    extent.Add(10, 179);
+    extent.Add(12, -179);
+    extent.Add(11, 181);  // same as -179
+
+    EXPECT_DOUBLE_EQ(extent.m_LatMin, 10);
+    EXPECT_DOUBLE_EQ(extent.m_LatMax, 12);
+    EXPECT_DOUBLE_EQ(extent.m_LonMin, 179);
+    EXPECT_DOUBLE_EQ(extent.m_LonSpan, 2);
+
+    PlugIn_ViewPort vp;
+    vp.bValid = true;
+    vp.lat_min = 0, vp.lat_max = 20;
+    vp.lon_min = 170, vp.lon_max = 190;
+    EXPECT_TRUE(extent.Intersects(vp));
+
+    vp.lon_min = -185, vp.lon_max = -175;
+    EXPECT_TRUE(extent.Intersects(vp));
+
+    vp.lon_min = -10, vp.lon_max = 10;
+    EXPECT_FALSE(extent.Intersects(vp));
+
+    vp.lon_min = 170, vp.lon_max = 190;
+    vp.lat_min = 15, vp.lat_max = 20;
+    EXPECT_FALSE(extent.Intersects(vp));
+}
+
+TEST(SightSimplifyTest, StripAcrossAntimeridian) {
+    /* two parallels from 170E to 170W, straight lines on a mercator chart */
+    std::vector<wxRealPoint> strip;
+    for (int i = 0; i <= 200; i++) {
+        double lon = resolve_heading(170 + i * 0.1);
+        strip.push_back(wxRealPoint(10, lon));
+        strip.push_back(wxRealPoint(11, lon));
+    }
+
+    std::vector<wxRealPoint> simplified = Sight::Simplify(strip, 0.01, true);
+    ASSERT_EQ(simplified.size(), 4u);
+    EXPECT_DOUBLE_EQ(simplified[0].y, 170);
+    EXPECT_DOUBLE_EQ(simplified[1].x, 11);
+    EXPECT_NEAR(simplified[3].y, -170, 1e-9);
+
+    /* a spike in one side keeps its pair and the pairs either side */
+    strip[201].x = 11.5;
+    simplified = Sight::Simplify(strip, 0.01, true);
+    ASSERT_EQ(simplified.size(), 10u);
+    EXPECT_DOUBLE_EQ(simplified[5].x, 11.5);
+
+    /* within tolerance it is dropped */
+    simplified = Sight::Simplify(strip, 1, true);
+    EXPECT_EQ(simplified.size(), 4u);
+}
+
+TEST(SightIndexTest, FindsBand) {
+    wxDateTime datetime;
+    ASSERT_TRUE(datetime.ParseDateTime("2024-06-01 12:00:00"));
+
+    std::vector<Sight> sights;
+    sights.push_back(Sight(Sight::ALTITUDE, "Sun", Sight::LOWER, datetime, 0,
+                           45, 10));
+    sights[0].Recompute(0);
+    sights[0].RebuildPolygons();
+
+    /* the middle of a step across the band is inside it */
+    std::list<wxRealPoint> points = sights[0].GetPoints();
+    ASSERT_GE(points.size(), 4u);
+    std::list<wxRealPoint>::iterator it = points.begin();
+    std::advance(it, 20);
+    wxRealPoint side1 = *it++, side2 = *it;
+    double lat = (side1.x + side2.x) / 2;
+    double lon = side1.y + resolve_heading(side2.y - side1.y) / 2;
+
+    SightIndex index;
+    index.Update(sights);
+    std::vector<int> found;
+    index.Find(lat, lon, 0.01, found);
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_EQ(found[0], 0);
+
+    /* the body's position is 45 degrees from the band */
+    double gplat, gplon;
+    sights[0].BodyLocation(sights[0].m_CorrectedDateTime, &gplat, &gplon, 0, 0,
+                           0);
+    index.Find(gplat, gplon, 0.01, found);
+    EXPECT_TRUE(found.empty());
+
+    sights[0].SetVisible(false);
+    index.Update(sights);
+    index.Find(lat, lon, 0.01, found);
+    EXPECT_TRUE(found.empty());
+}
@@ -0,0 +1,56 @@
+/***************************************************************************
+ *   Copyright (C) 2024 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif  // precompiled headers
+
+#include <gtest/gtest.h>
+#include "ocpn_plugin.h"
+#include "Sight.h"
+#include <cmath>
+#include "common.h"
+
+// Every vertex of a true azimuth line of position must see the body
+// within the measurement certainty of the measured azimuth.
+TEST(AzimuthTest, TrueBearingLineOfPosition) {
+    const double azimuths[] = {0, 45, 100, 180, 250, 315};
+
+    wxDateTime datetime;
+    ASSERT_TRUE(datetime.ParseDateTime("2024-06-21 12:00:00"));
+
+    for (double azimuth : azimuths) {
+        Sight sight(Sight::AZIMUTH, "Sun", Sight::CENTER, datetime, 0, azimuth, 30);
+        sight.m_bMagneticNorth = false;
+        sight.Recompute(0);
+        sight.RebuildPolygons();
+
+        double gplat, gplon;
+        sight.BodyLocation(sight.m_CorrectedDateTime, &gplat, &gplon, nullptr,
+                           nullptr, nullptr);
+
+        std::list<wxRealPoint> points = sight.GetPoints();
+        ASSERT_FALSE(points.empty()) << "no polygons for azimuth " << azimuth;
+
+        for (const wxRealPoint &p : points) {
+            double dlon = resolve_heading(p.y - gplon);
+            // the azimuth is undefined at the geographical position and poles
+            if ((fabs(p.x - gplat) < .5 && fabs(dlon) < .5) || fabs(p.x) > 89.5)
+                continue;
+
+            double hc, zn;
+            sight.AltitudeAzimuth(p.x, p.y, gplat, gplon, &hc, &zn);
+            EXPECT_NEAR(resolve_heading(zn - azimuth), 0, .5 + .01)
+                << "azimuth " << azimuth << " at " << p.x << ", " << p.y;
+            EXPECT_GE(hc, 0);
+        }
+    }
+}
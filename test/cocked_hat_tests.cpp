@@ -0,0 +1,147 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif  // precompiled headers
+
+#include <gtest/gtest.h>
+#include "ocpn_plugin.h"
+#include "Sight.h"
+#include "CockedHat.h"
+#include "FixEngine.h"
+#include "celestial_navigation_pi.h"
+#include <chrono>
+#include <cmath>
+#include "common.h"
+
+TEST(CockedHatTest, Triangle) {
+    /* three bodies seen from 35N 45W, each altitude a little off so their
+       lines leave a hat about the fix */
+    double lat0 = 35, lon0 = -45;
+    double gps[3][2] = {{20, -20}, {10, -70}, {60, -50}};
+    double off[3] = {1.0 / 60, -1.5 / 60, 2.0 / 60};
+    std::vector<FixContribution> c;
+    for (int i = 0; i < 3; i++)
+        c.push_back(ContributionFrom(lat0, lon0, gps[i][0], gps[i][1], off[i]));
+
+    FixEngine engine;
+    for (FixContribution& k : c) engine.Add(k);
+    double lat = lat0, lon = lon0, error;
+    ASSERT_TRUE(engine.Solve(FixEngine::PLANE, lat, lon, error));
+
+    CockedHat hat;
+    hat.Update(c, lat, lon);
+    EXPECT_EQ(hat.Crossings(), 3);
+    ASSERT_EQ(hat.Hat().size(), 3u);
+
+    /* each corner is on two of the lines, and the inscribed point as far
+       from all three as the radius, which times half the perimeter is the
+       area of a triangle */
+    double perimeter = 0;
+    for (int i = 0; i < 3; i++) {
+        const wxRealPoint& p = hat.Hat()[i];
+        int on = 0;
+        for (int j = 0; j < 3; j++)
+            if (fabs(CircleDistance(c[j], p.x, p.y)) < 1e-6) on++;
+        EXPECT_EQ(on, 2) << i;
+
+        const wxRealPoint& q = hat.Hat()[(i + 1) % 3];
+        double dn = (q.x - p.x) * 60;
+        double de = (q.y - p.y) * 60 * cos(d_to_r(lat));
+        perimeter += sqrt(dn * dn + de * de);
+    }
+    double ilat, ilon, radius;
+    ASSERT_TRUE(hat.Inscribed(ilat, ilon, radius));
+    EXPECT_GT(radius, .1);
+    for (int i = 0; i < 3; i++)
+        EXPECT_NEAR(fabs(CircleDistance(c[i], ilat, ilon)), radius, .01);
+    EXPECT_NEAR(radius * perimeter / 2, hat.Area(), .01 * hat.Area());
+
+    /* changing one sight only crosses it again with the other two */
+    c[1] = ContributionFrom(lat0, lon0, gps[1][0], gps[1][1],
+                            off[1] + 1.0 / 60);
+    hat.Update(c, lat, lon);
+    EXPECT_EQ(hat.Computed(), 2);
+    CockedHat fresh;
+    fresh.Update(c, lat, lon);
+    EXPECT_EQ(fresh.Computed(), 3);
+    EXPECT_DOUBLE_EQ(hat.Area(), fresh.Area());
+
+    /* two hundred sights, every pair crossed and then one sight changed */
+    c.clear();
+    for (int i = 0; i < 200; i++) {
+        double gplat = -20 + (i * 37) % 80, gplon = lon0 - 70 + (i * 53) % 140;
+        c.push_back(ContributionFrom(lat0, lon0, gplat, gplon,
+                                     (i % 5 - 2) / 60.0));
+    }
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    hat.Update(c, lat0, lon0);
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+    std::cout << "hat of 200 sights in " << ms << " ms" << std::endl;
+    EXPECT_GT(hat.Crossings(), 19000);
+    ASSERT_GE(hat.Hat().size(), 3u);
+
+    /* the hat is the cell holding the fix, no line passes through it */
+    for (const wxRealPoint& p : hat.Hat())
+        for (FixContribution& k : c) {
+            double d = CircleDistance(k, p.x, p.y);
+            double fix = CircleDistance(k, lat0, lon0);
+            EXPECT_GT(d * (fix > 0 ? 1 : -1), -1e-6);
+        }
+
+    c[7].sm = sin(asin(c[7].sm) + d_to_r(1.0 / 60));
+    hat.Update(c, lat0, lon0);
+    EXPECT_EQ(hat.Computed(), 199);
+}
+
+TEST(CockedHatTest, CellOfFourLines) {
+    /* four bodies around the sky, with the lines of two pairs moved apart
+       so all six crossings are spread over a few miles */
+    double lat0 = 35, lon0 = -45;
+    double gps[4][2] = {{20, -20}, {10, -70}, {60, -50}, {40, -90}};
+    double off[4] = {2.0 / 60, -2.0 / 60, 1.0 / 60, -1.0 / 60};
+    std::vector<FixContribution> c;
+    for (int i = 0; i < 4; i++)
+        c.push_back(ContributionFrom(lat0, lon0, gps[i][0], gps[i][1], off[i]));
+
+    FixEngine engine;
+    for (FixContribution& k : c) engine.Add(k);
+    double lat = lat0, lon = lon0, error;
+    ASSERT_TRUE(engine.Solve(FixEngine::PLANE, lat, lon, error));
+
+    CockedHat hat;
+    hat.Update(c, lat, lon);
+    EXPECT_EQ(hat.Crossings(), 6);
+    ASSERT_GE(hat.Hat().size(), 3u);
+    EXPECT_LT(hat.Hat().size(), 6u);
+
+    /* every corner is on two lines and on the fix's side of the others,
+       and the inscribed circle is inside each line */
+    for (const wxRealPoint& p : hat.Hat()) {
+        int on = 0;
+        for (FixContribution& k : c) {
+            double d = CircleDistance(k, p.x, p.y);
+            double fix = CircleDistance(k, lat, lon);
+            if (fabs(d) < 1e-6)
+                on++;
+            else
+                EXPECT_GT(d * fix, 0);
+        }
+        EXPECT_EQ(on, 2);
+    }
+    double ilat, ilon, radius;
+    ASSERT_TRUE(hat.Inscribed(ilat, ilon, radius));
+    for (FixContribution& k : c)
+        EXPECT_GT(fabs(CircleDistance(k, ilat, ilon)), radius - .01);
+}
@@ -8,6 +8,8 @@
 #include <gtest/gtest.h>
 #include "ocpn_plugin.h"
 #include "Sight.h"
+#include "FixEngine.h"
+#include "celestial_navigation_pi.h"
 #include <cmath>
 #include <iomanip>
 #include <sstream>
@@ -79,4 +81,47 @@ void report(const char *name, const char *type, std::vector<int> &vec) {
               << " (" << ((overone * 100) / vec.size()) << "%)" << std::endl;
 }
 
+// Altitude in degrees of a body at gplat, gplon seen from lat, lon
+double AltitudeFrom(double lat, double lon, double gplat, double gplon) {
+    return r_to_d(asin(sin(d_to_r(lat)) * sin(d_to_r(gplat)) +
+                       cos(d_to_r(lat)) * cos(d_to_r(gplat)) *
+                           cos(d_to_r(lon - gplon))));
+}
+
+// Line of position of a body at gplat, gplon seen from lat, lon, offset
+// degrees higher, certain to 1' with the time exact
+FixContribution ContributionFrom(double lat, double lon, double gplat,
+                                 double gplon, double offset) {
+    return FixEngine::Contribution(
+        gplat, gplon, AltitudeFrom(lat, lon, gplat, gplon) + offset, 1, 0, 15);
+}
+
+// Nautical miles from lat, lon to the circle of c, positive inside it
+double CircleDistance(const FixContribution &c, double lat, double lon) {
+    double sm = sin(d_to_r(lat)) * c.z +
+                cos(d_to_r(lat)) * (cos(d_to_r(lon)) * c.x +
+                                    sin(d_to_r(lon)) * c.y);
+    return r_to_d(asin(sm) - asin(c.sm)) * 60;
+}
 
+// Sight of the sun certain to 1', taken hours after datetime from lat, lon
+Sight SunSightFrom(double lat, double lon, const char *datetime, int hours) {
+    wxDateTime time;
+    EXPECT_TRUE(time.ParseDateTime(datetime));
+    time += wxTimeSpan::Hours(hours);
+    Sight s(Sight::ALTITUDE, "Sun", Sight::CENTER, time, 0, 0, 1);
+
+    double gplat, gplon;
+    s.BodyLocation(time, &gplat, &gplon, 0, 0, 0);
+    s.m_ObservedAltitude = AltitudeFrom(lat, lon, gplat, gplon);
+    return s;
+}
+
+// count sights of the sun from lat, lon, every so many hours from start
+std::vector<Sight> SunSightsFrom(double lat, double lon, const char *start,
+                                 int count, int hours) {
+    std::vector<Sight> sights;
+    for (int i = 0; i < count; i++)
+        sights.push_back(SunSightFrom(lat, lon, start, hours * i));
+    return sights;
+}
@@ -8,3 +8,15 @@ struct degmin {
     double deg;
     double min;
 };
+
+class Sight;
+struct FixContribution;
+
+// Sights and lines of position of bodies as seen from lat, lon
+double AltitudeFrom(double lat, double lon, double gplat, double gplon);
+FixContribution ContributionFrom(double lat, double lon, double gplat,
+                                 double gplon, double offset = 0);
+double CircleDistance(const FixContribution &c, double lat, double lon);
+Sight SunSightFrom(double lat, double lon, const char *datetime, int hours = 0);
+std::vector<Sight> SunSightsFrom(double lat, double lon, const char *start,
+                                 int count, int hours);
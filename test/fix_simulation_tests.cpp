@@ -0,0 +1,96 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif  // precompiled headers
+
+#include <gtest/gtest.h>
+#include "ocpn_plugin.h"
+#include "Sight.h"
+#include "FixEngine.h"
+#include "FixSimulation.h"
+#include "celestial_navigation_pi.h"
+#include <chrono>
+#include <cmath>
+#include "common.h"
+
+TEST(FixSimulationTest, MatchesCovariance) {
+    /* the sun every two hours from 30N 40W measured to 1' */
+    double lat0 = 30, lon0 = -40;
+    std::vector<Sight> sights =
+        SunSightsFrom(lat0, lon0, "2024-06-01 10:00:00", 4, 2);
+    for (Sight& s : sights) {
+        s.m_ArtificialHorizon = true;  // no dip
+        s.m_Pressure = 0;              // nor refraction
+    }
+
+    FixEngine engine;
+    engine.Update(sights, 0, lat0, lon0);
+    double lat = lat0, lon = lon0, error, C[2][2];
+    ASSERT_TRUE(engine.Solve(FixEngine::SPHERE, lat, lon, error));
+    ASSERT_TRUE(engine.Covariance(lat, lon, C));
+
+    std::vector<FixSimulation::Input> inputs;
+    for (Sight& s : sights) {
+        FixContribution c;
+        ASSERT_TRUE(engine.Find(s, 0, c));
+        inputs.push_back(FixSimulation::MakeInput(s, c));
+    }
+
+    /* the index error is one for the whole fix, it raises every line alike
+       and so moves the fix by g nautical miles east and north for each
+       tenth of a minute it is off */
+    std::vector<Sight> raised = sights;
+    for (Sight& s : raised) s.m_ObservedAltitude += .1 / 60;
+    FixEngine biased;
+    biased.Update(raised, 0, lat0, lon0);
+    double blat = lat, blon = lon;
+    ASSERT_TRUE(biased.Solve(FixEngine::SPHERE, blat, blon, error));
+    double g[2] = {(blon - lon) * 60 * cos(d_to_r(lat)), (blat - lat) * 60};
+
+    FixSimulation simulation;
+    const int samples = 4000;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(simulation.Run(inputs, FixEngine::SPHERE, lat, lon, samples),
+              samples);
+    double micros = std::chrono::duration<double, std::micro>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    std::cout << samples << " samples in " << micros << " us" << std::endl;
+
+    double slat, slon, S[2][2];
+    ASSERT_TRUE(simulation.Spread(slat, slon, S));
+    EXPECT_NEAR(slat, lat, .1 / 60);
+    EXPECT_NEAR(slon, lon, .1 / 60);
+    EXPECT_NEAR(S[0][0], C[0][0] + g[0] * g[0], .1 * C[0][0]);
+    EXPECT_NEAR(S[1][1], C[1][1] + g[1] * g[1], .1 * C[1][1]);
+    EXPECT_NEAR(S[0][1], C[0][1] + g[0] * g[1],
+                .1 * sqrt(C[0][0] * C[1][1]));
+
+    /* the same seeds give the same samples */
+    std::vector<wxRealPoint> points = simulation.Points();
+    simulation.Run(inputs, FixEngine::SPHERE, lat, lon, samples);
+    EXPECT_EQ(points[samples - 1].x, simulation.Points()[samples - 1].x);
+
+    /* dip and refraction only add to the spread */
+    for (FixSimulation::Input& in : inputs) {
+        in.eyeheight = 2;
+        in.dip = Sight::Dip(2, 0);
+        in.pressure = 1013;
+        in.refraction = 1 / 60.0;
+    }
+    simulation.Run(inputs, FixEngine::SPHERE, lat, lon, samples);
+    double W[2][2];
+    ASSERT_TRUE(simulation.Spread(slat, slon, W));
+    EXPECT_GT(W[0][0] + W[1][1], S[0][0] + S[1][1]);
+}
+
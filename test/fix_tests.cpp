@@ -0,0 +1,291 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif  // precompiled headers
+
+#include <gtest/gtest.h>
+#include "ocpn_plugin.h"
+#include "Sight.h"
+#include "FixEngine.h"
+#include "celestial_navigation_pi.h"
+#include <chrono>
+#include <cmath>
+#include "common.h"
+
+TEST(FixEngineTest, UpdatesIncrementally) {
+    /* the sun three hours apart, with the altitudes seen from 30N 40W */
+    double lat0 = 30, lon0 = -40;
+    std::vector<Sight> sights =
+        SunSightsFrom(lat0, lon0, "2024-06-01 12:00:00", 3, 3);
+
+    FixEngine engine;
+    EXPECT_FALSE(engine.Update(sights, 0, lat0, lon0));
+    EXPECT_EQ(engine.Count(), 3);
+    for (int algorithm = 0; algorithm < 4; algorithm++) {
+        double lat = 25, lon = -30, error;
+        ASSERT_TRUE(engine.Solve(algorithm, lat, lon, error)) << algorithm;
+        EXPECT_NEAR(lat, lat0, 1e-6) << algorithm;
+        EXPECT_NEAR(lon, lon0, 1e-6) << algorithm;
+        EXPECT_LT(error, 1e-6) << algorithm;
+    }
+
+    /* moving one line a mile moves the fix and leaves a residual */
+    sights[1].m_ObservedAltitude += 1 / 60.0;
+    engine.Update(sights, 0, lat0, lon0);
+    EXPECT_EQ(engine.Count(), 3);
+    double lat = 25, lon = -30, error;
+    ASSERT_TRUE(engine.Solve(0, lat, lon, error));
+    EXPECT_GT(fabs(lat - lat0) + fabs(lon - lon0), 1 / 120.0);
+
+    /* back again matches the fix from scratch */
+    sights[1].m_ObservedAltitude -= 1 / 60.0;
+    sights[2].SetVisible(false);
+    engine.Update(sights, 0, lat0, lon0);
+    EXPECT_EQ(engine.Count(), 2);
+    lat = 25, lon = -30;
+    ASSERT_TRUE(engine.Solve(0, lat, lon, error));
+    EXPECT_NEAR(lat, lat0, 1e-6);
+    EXPECT_NEAR(lon, lon0, 1e-6);
+
+    sights[1].SetVisible(false);
+    engine.Update(sights, 0, lat0, lon0);
+    EXPECT_FALSE(engine.Solve(0, lat, lon, error));
+
+    sights[0].m_ShiftNm = 10;
+    EXPECT_TRUE(engine.Update(sights, 0, lat0, lon0));
+    EXPECT_EQ(engine.Count(), 1);
+}
+
+TEST(FixEngineTest, SkipsSightWithoutAltitude) {
+    /* a sight not yet measured is left out rather than spoiling the sums */
+    double lat0 = 30, lon0 = -40;
+    std::vector<Sight> sights =
+        SunSightsFrom(lat0, lon0, "2024-06-01 10:00:00", 3, 2);
+    sights[1].m_ObservedAltitude = NAN;
+
+    FixEngine engine;
+    engine.Update(sights, 0, lat0, lon0);
+    EXPECT_EQ(engine.Count(), 2);
+    engine.Update(sights, 0, lat0, lon0);
+    EXPECT_EQ(engine.Count(), 2);
+
+    double lat = 25, lon = -30, error;
+    ASSERT_TRUE(engine.Solve(FixEngine::SPHERE, lat, lon, error));
+    EXPECT_NEAR(lat, lat0, 1e-6);
+    EXPECT_NEAR(lon, lon0, 1e-6);
+    FixContribution c;
+    EXPECT_FALSE(engine.Find(sights[1], 0, c));
+}
+
+TEST(FixEngineTest, RunningFix) {
+    /* the sun at 10 from 30N 40W, then at 13 and 15 after sailing 30 miles
+       north */
+    double lat0 = 30.5, lon0 = -40;
+    std::vector<Sight> sights;
+    for (int hour : {10, 13, 15}) {
+        Sight s = SunSightFrom(hour == 10 ? 30 : lat0, lon0,
+                               "2024-06-01 00:00:00", hour);
+        if (hour == 10) {
+            s.m_ShiftNm = 30;
+            s.m_ShiftBearing = 0;
+            s.m_bMagneticShiftBearing = false;
+        }
+        sights.push_back(s);
+    }
+
+    /* moved about the first fix, then again about the one it gives */
+    FixEngine engine;
+    double lat = 25, lon = -30, error;
+    EXPECT_TRUE(engine.Update(sights, 0, lat, lon));
+    ASSERT_TRUE(engine.Solve(FixEngine::PLANE, lat, lon, error));
+    EXPECT_TRUE(engine.Update(sights, 0, lat, lon));
+    EXPECT_EQ(engine.Count(), 3);
+    lat = 25, lon = -30;
+    ASSERT_TRUE(engine.Solve(FixEngine::PLANE, lat, lon, error));
+    EXPECT_NEAR(lat, lat0, 1e-4);
+    EXPECT_NEAR(lon, lon0, 1e-4);
+    EXPECT_LT(error, 1e-6);
+}
+
+TEST(FixEngineTest, ErrorEllipse) {
+    /* from 0N 0E one body due east and one due north, both 30 degrees up,
+       certain to 1' and 2' */
+    FixEngine engine;
+    engine.Add(FixEngine::Contribution(0, 60, 30, 1, 0, 15));
+    engine.Add(FixEngine::Contribution(60, 0, 30, 2, 0, 15));
+
+    double lat = 1, lon = 1, error;
+    ASSERT_TRUE(engine.Solve(0, lat, lon, error));
+    EXPECT_NEAR(lat, 0, 1e-9);
+    EXPECT_NEAR(lon, 0, 1e-9);
+
+    /* each line is only uncertain across itself */
+    double C[2][2];
+    ASSERT_TRUE(engine.Covariance(lat, lon, C));
+    EXPECT_NEAR(C[0][0], 1, 1e-9);
+    EXPECT_NEAR(C[1][1], 4, 1e-9);
+    EXPECT_NEAR(C[0][1], 0, 1e-9);
+
+    /* one standard deviation holds 1 - exp(-1/2) */
+    double major, minor, bearing;
+    FixEngine::Ellipse(C, 1 - exp(-.5), major, minor, bearing);
+    EXPECT_NEAR(major, 2, 1e-6);
+    EXPECT_NEAR(minor, 1, 1e-6);
+    EXPECT_NEAR(bearing, 0, 1e-6);
+
+    /* a time error only counts through the body's motion */
+    engine.Clear();
+    engine.Add(FixEngine::Contribution(0, 60, 30, 1, 4, 15));
+    engine.Add(FixEngine::Contribution(60, 0, 30, 1, 4, 15));
+    ASSERT_TRUE(engine.Covariance(0, 0, C));
+    EXPECT_NEAR(C[0][0], 2, 1e-9);
+    EXPECT_NEAR(C[1][1], 1 + .25, 1e-9);
+}
+
+TEST(FixEngineTest, SolvesClock) {
+    /* the sun every hour seen from 30N 40W by a clock 30 seconds slow */
+    double lat0 = 30, lon0 = -40;
+    std::vector<Sight> sights =
+        SunSightsFrom(lat0, lon0, "2024-06-01 10:00:00", 6, 1);
+    for (Sight& s : sights) s.m_DateTime -= wxTimeSpan::Seconds(30);
+
+    /* the fix alone is 7.5' of longitude west */
+    FixEngine engine;
+    engine.Update(sights, 0, lat0, lon0);
+    double lat = 25, lon = -30, error;
+    ASSERT_TRUE(engine.Solve(FixEngine::PLANE, lat, lon, error));
+    EXPECT_NEAR(lat, lat0, 1e-3);
+    EXPECT_NEAR(lon, lon0 + 30 * 15 / 3600.0, 1e-3);
+
+    /* knowing where the boat was gives the clock */
+    double clock = 0, C[3][3];
+    lat = 25, lon = -30;
+    ASSERT_TRUE(
+        engine.SolveClock(lat, lon, error, clock, C, lat0, lon0, .1));
+    EXPECT_NEAR(clock, 30, 1);
+    EXPECT_NEAR(lat, lat0, 1e-3);
+    EXPECT_NEAR(lon, lon0, 1e-2);
+    EXPECT_GT(C[2][2], 0);
+    EXPECT_LT(sqrt(C[2][2]), 5);
+
+    /* without it the clock and longitude can't be told apart */
+    lat = 25, lon = -30, clock = 0;
+    EXPECT_FALSE(engine.SolveClock(lat, lon, error, clock, C) &&
+                 sqrt(C[2][2]) < 60);
+
+    /* once applied there is nothing left to correct */
+    engine.Update(sights, 30, lat0, lon0);
+    lat = 25, lon = -30, clock = 0;
+    ASSERT_TRUE(
+        engine.SolveClock(lat, lon, error, clock, C, lat0, lon0, .1));
+    EXPECT_NEAR(clock, 0, 1e-3);
+    EXPECT_NEAR(lon, lon0, 1e-6);
+}
+
+TEST(FixEngineTest, RatesFollowTheBody) {
+    wxDateTime time;
+    ASSERT_TRUE(time.ParseDateTime("2024-03-20 12:00:00"));
+
+    /* the sun's hour angle grows at the earth's rate of turn, near the
+       equinox its declination climbs a degree in a little over two days */
+    Sight sun(Sight::ALTITUDE, "Sun", Sight::CENTER, time, 0, 0, 1);
+    double rate, decrate;
+    FixEngine::Rates(sun, time, rate, decrate);
+    EXPECT_NEAR(rate, 15, .01);
+    EXPECT_NEAR(decrate, .0165, .001);
+
+    /* the moon falls behind it, moving north or south as well, and a
+       contribution moved by its rates is where the ephemeris puts it */
+    Sight moon(Sight::ALTITUDE, "Moon", Sight::CENTER, time, 0, 0, 1);
+    FixEngine::Rates(moon, time, rate, decrate);
+    EXPECT_GT(rate, 14);
+    EXPECT_LT(rate, 14.8);
+    EXPECT_LT(fabs(decrate), .3);
+
+    double gplat, gplon, lat, lon;
+    moon.BodyLocation(time, &gplat, &gplon, 0, 0, 0);
+    moon.BodyLocation(time + wxTimeSpan::Minutes(10), &lat, &lon, 0, 0, 0);
+    FixContribution c = FixEngine::Later(
+        FixEngine::Contribution(gplat, gplon, 30, 1, 0, rate, decrate), 600);
+    EXPECT_NEAR(r_to_d(asin(c.z)), lat, 1e-3);
+    EXPECT_NEAR(r_to_d(atan2(c.y, c.x)), lon, 1e-3);
+}
+
+TEST(FixEngineTest, RobustRejectsBlunder) {
+    /* the sun every hour seen from 30N 40W, one sight half a degree off */
+    double lat0 = 30, lon0 = -40;
+    std::vector<Sight> sights =
+        SunSightsFrom(lat0, lon0, "2024-06-01 10:00:00", 8, 1);
+    sights[5].m_ObservedAltitude += .5;
+
+    FixEngine engine;
+    engine.Update(sights, 0, lat0, lon0);
+
+    double lat = 25, lon = -30, error;
+    ASSERT_TRUE(engine.Solve(FixEngine::PLANE, lat, lon, error));
+    EXPECT_GT(fabs(lat - lat0) + fabs(lon - lon0), .05);
+    for (Sight& s : sights) EXPECT_FALSE(engine.IsOutlier(s, 0));
+
+    lat = 25, lon = -30;
+    ASSERT_TRUE(engine.Solve(FixEngine::ROBUST, lat, lon, error));
+    EXPECT_NEAR(lat, lat0, 1e-6);
+    EXPECT_NEAR(lon, lon0, 1e-6);
+    for (int i = 0; i < 8; i++)
+        EXPECT_EQ(engine.IsOutlier(sights[i], 0), i == 5) << i;
+}
+
+TEST(FixEngineTest, SearchFindsEveryFix) {
+    /* two bodies seen from 35N 45W, whose circles also cross where that
+       point is mirrored in the plane of their geographic positions */
+    double lat0 = 35, lon0 = -45;
+    double gps[3][2] = {{20, -20}, {10, -70}, {50, -10}};
+    FixContribution c[3];
+    for (int i = 0; i < 3; i++)
+        c[i] = ContributionFrom(lat0, lon0, gps[i][0], gps[i][1]);
+
+    FixEngine engine;
+    engine.Add(c[0]);
+    engine.Add(c[1]);
+    std::vector<FixEngine::Candidate> candidates;
+    engine.Search(FixEngine::SPHERE, candidates);
+    ASSERT_EQ(candidates.size(), 2u);
+    int k = fabs(candidates[0].lat - lat0) < 1e-6 ? 0 : 1;
+    EXPECT_NEAR(candidates[k].lat, lat0, 1e-6);
+    EXPECT_NEAR(candidates[k].lon, lon0, 1e-6);
+    EXPECT_GT(fabs(candidates[1 - k].lat - lat0) +
+                  fabs(candidates[1 - k].lon - lon0), 1);
+    for (FixEngine::Candidate& f : candidates) {
+        EXPECT_LT(f.error, 1e-6);
+        double X[3] = {cos(d_to_r(f.lat)) * cos(d_to_r(f.lon)),
+                       cos(d_to_r(f.lat)) * sin(d_to_r(f.lon)),
+                       sin(d_to_r(f.lat))};
+        for (int i = 0; i < 2; i++)
+            EXPECT_NEAR(c[i].x * X[0] + c[i].y * X[1] + c[i].z * X[2],
+                        c[i].sm, 1e-9);
+    }
+
+    /* a third body leaves one fix, found without a position to start */
+    engine.Add(c[2]);
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    engine.Search(FixEngine::SPHERE, candidates);
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+    std::cout << "search of 3 sights in " << ms << " ms" << std::endl;
+    ASSERT_GE(candidates.size(), 1u);
+    EXPECT_NEAR(candidates[0].lat, lat0, 1e-6);
+    EXPECT_NEAR(candidates[0].lon, lon0, 1e-6);
+    for (size_t i = 1; i < candidates.size(); i++)
+        EXPECT_GT(candidates[i].error, .001);
+}
+
@@ -304,6 +304,10 @@ bool wxAuiPaneInfo::IsValid() const { return true; }
 
 void DimeWindow(wxWindow* win) {}
 void GetCanvasPixLL(PlugIn_ViewPort* vp, wxPoint* pp, double lat, double lon) {}
+void GetCanvasLLPix(PlugIn_ViewPort* vp, wxPoint p, double* plat,
+                    double* plon) {}
+void GetDoubleCanvasPixLL(PlugIn_ViewPort* vp, wxPoint2DDouble* pp, double lat,
+                          double lon) {}
 void RequestRefresh(wxWindow* window) {}
 
 extern DECL_EXP wxString GetLocaleCanonicalName() {
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif  // precompiled headers
+
+#include <gtest/gtest.h>
+#include "ocpn_plugin.h"
+#include "Sight.h"
+#include "FixEngine.h"
+#include "ResidualMap.h"
+#include "celestial_navigation_pi.h"
+#include <chrono>
+#include <cmath>
+#include <random>
+#include "common.h"
+
+TEST(ResidualMapTest, LeastAtFix) {
+    /* three bodies seen from 30N 40W on a grid two degrees across, with the
+       right hand columns off the globe */
+    double gps[3][2] = {{20, -10}, {-5, -70}, {50, -45}};
+    std::vector<FixContribution> c;
+    for (auto& gp : gps) c.push_back(ContributionFrom(30, -40, gp[0], gp[1]));
+
+    ResidualMap map;
+    map.Evaluate(c, 101, 101,
+                 [](double x, double y, double& lat, double& lon) {
+                     lat = 31 - 2 * y / 100, lon = -41 + 2 * x / 100;
+                     if (x > 90) lat = lon = NAN;
+                 });
+
+    const std::vector<double>& v = map.Values();
+    int least = 0;
+    for (int i = 0; i < 101 * 101; i++)
+        if (v[i] < v[least]) least = i;
+    EXPECT_EQ(least % 101, 50);
+    EXPECT_EQ(least / 101, 50);
+    EXPECT_NEAR(map.Least(), 0, 1e-3);
+
+    /* between lattice nodes the sum is still that of the sights */
+    int x = 13, y = 27;
+    double lat = 31 - 2 * y / 100.0, lon = -41 + 2 * x / 100.0, sum = 0;
+    for (const FixContribution& k : c) {
+        double d = k.x * cos(d_to_r(lat)) * cos(d_to_r(lon)) +
+                   k.y * cos(d_to_r(lat)) * sin(d_to_r(lon)) +
+                   k.z * sin(d_to_r(lat)) - k.sm;
+        sum += k.w * d * d;
+    }
+    EXPECT_NEAR(v[y * 101 + x], sum, sum * 1e-3);
+
+    /* off the globe is clear, there are contours and no gaps elsewhere */
+    const std::vector<unsigned char>& p = map.Pixels();
+    int contours = 0;
+    for (int j = 0; j < 101; j++)
+        for (int i = 0; i < 101; i++) {
+            unsigned char alpha = p[4 * (j * 101 + i) + 3];
+            if (i > 90) EXPECT_EQ(alpha, 0);
+            if (i < 88) EXPECT_GT(alpha, 0);
+            if (alpha && !p[4 * (j * 101 + i)] &&
+                !p[4 * (j * 101 + i) + 1] && !p[4 * (j * 101 + i) + 2])
+                contours++;
+        }
+    EXPECT_GT(contours, 100);
+}
+
+TEST(ResidualMapTest, Benchmark) {
+    /* 200 sights over a 512 x 512 grid ten degrees across */
+    std::mt19937 random(1);
+    std::uniform_real_distribution<double> u(-1, 1);
+    std::vector<FixContribution> c;
+    for (int i = 0; i < 200; i++) {
+        double gplat = 60 * u(random), gplon = -40 + 60 * u(random);
+        double altitude = AltitudeFrom(30, -40, gplat, gplon);
+        c.push_back(FixEngine::Contribution(gplat, gplon,
+                                            altitude + u(random) / 60, 1, 1,
+                                            15));
+    }
+
+    ResidualMap map;
+    auto start = std::chrono::steady_clock::now();
+    map.Evaluate(c, 512, 512, [](double x, double y, double& lat,
+                                 double& lon) {
+        lat = 35 - 10 * y / 511, lon = -45 + 10 * x / 511;
+    });
+    double millis = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    std::cout << "512 x 512 residual map in " << millis << " ms" << std::endl;
+
+    EXPECT_TRUE(std::isfinite(map.Least()));
+}
+
@@ -0,0 +1,123 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by OpenCPN development team                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ **************************************************************************/
+
+#include "wx/wxprec.h"
+
+#ifndef WX_PRECOMP
+#include "wx/wx.h"
+#endif  // precompiled headers
+
+#include <gtest/gtest.h>
+#include "ocpn_plugin.h"
+#include "Sight.h"
+#include "TrackEstimator.h"
+#include "celestial_navigation_pi.h"
+#include <cmath>
+#include "common.h"
+
+TEST(TrackEstimatorTest, FollowsTrack) {
+    /* a day at 6 knots east from 30N 40W in a 1 knot north current the
+       log doesn't see, with three bodies every two hours.  Fed as taken,
+       then six hours late, then taken with speed and course over the
+       ground, which have the current in them */
+    for (int run = 0; run < 3; run++) {
+        bool late = run == 1, ground = run == 2;
+        double lat = 30, lon = -40, t0 = 1.7e9;
+        TrackEstimator track;
+        track.Start(t0, lat + .5, lon - .5, 60);
+
+        struct Pending { double time, gplat, gplon, altitude; };
+        std::vector<Pending> pending;
+        for (int s = 0; s <= 24 * 3600; s += 60) {
+            double t = t0 + s;
+            if (ground)
+                track.Motion(t, r_to_d(atan2(6, 1)), hypot(6, 1), true);
+            else
+                track.Motion(t, 90, 6, false);
+            if (s && s % 7200 == 0)
+                for (int b = 0; b < 3; b++) {
+                    double gplat = b == 0 ? 20 : b == 1 ? -10 : 45;
+                    double gplon =
+                        resolve_heading(20 + b * 100 - 15 * s / 3600.0);
+                    double altitude = AltitudeFrom(lat, lon, gplat, gplon);
+                    if (altitude < 10) continue;
+                    Pending p = {t, gplat, gplon, altitude};
+                    pending.push_back(p);
+                }
+            if (!late || s % (6 * 3600) == 0) {
+                for (Pending& p : pending)
+                    EXPECT_TRUE(track.Altitude(p.time, p.gplat, p.gplon,
+                                               p.altitude, .5));
+                pending.clear();
+            }
+            lat += 1 / 3600.0;
+            lon += 6 / (3600.0 * cos(d_to_r(lat)));
+        }
+        lat -= 1 / 3600.0;
+        lon -= 6 / (3600.0 * cos(d_to_r(lat)));
+
+        const TrackPoint& p = track.Track().back();
+        EXPECT_GT(track.Sights(), 10) << run;
+        EXPECT_GT(track.Track().size(), 24u * 60) << run;
+        EXPECT_NEAR(p.lat, lat, .01) << run;
+        EXPECT_NEAR(p.lon, lon, .01) << run;
+        EXPECT_LT(p.C[0][0] + p.C[1][1], 1) << run;
+        EXPECT_NEAR(track.CurrentNorth(), ground ? 0 : 1, .1) << run;
+        EXPECT_NEAR(track.CurrentEast(), 0, .1) << run;
+
+        /* a blunder is turned away */
+        EXPECT_FALSE(track.Altitude(p.time, 20, -40, 10, .5));
+    }
+}
+
+
+TEST(TrackEstimatorTest, UpdatesFromSights) {
+    /* a boat hove to at 30N 40W, the track started from a guess 20' off at
+       09:30 UTC, with the sun every hour from 10:00 and one from before */
+    double lat = 30, lon = -40;
+    wxDateTime start;
+    ASSERT_TRUE(start.ParseDateTime("2024-06-01 09:30:00"));
+    start.MakeFromUTC();
+    TrackEstimator track;
+    track.Start(start.GetTicks(), lat + .3, lon - .3, 60);
+
+    std::vector<Sight> sights =
+        SunSightsFrom(lat, lon, "2024-06-01 10:00:00", 6, 1);
+    sights.push_back(SunSightFrom(lat, lon, "2024-06-01 09:00:00"));
+    EXPECT_EQ(track.Update(sights, 0), 6);
+    EXPECT_EQ(track.Sights(), 6);
+
+    /* the sight times are UTC, the last is five and a half hours in */
+    const TrackPoint& p = track.Track().back();
+    EXPECT_EQ(p.time, start.GetTicks() + 5.5 * 3600);
+    EXPECT_NEAR(p.lat, lat, .05);
+    EXPECT_NEAR(p.lon, lon, .05);
+
+    /* sights already used are not used again */
+    EXPECT_EQ(track.Update(sights, 0), 0);
+}
+
+TEST(TrackEstimatorTest, RetriesTurnedAwaySights) {
+    /* started 20' off but trusted to a mile, so a sight at the start is
+       taken for a blunder.  A day of dead reckoning later the estimate is
+       loose enough for it */
+    double lat = 30, lon = -40;
+    wxDateTime start;
+    ASSERT_TRUE(start.ParseDateTime("2024-06-01 10:00:00"));
+    start.MakeFromUTC();
+    TrackEstimator track;
+    track.Start(start.GetTicks(), lat + .3, lon - .3, 1);
+
+    std::vector<Sight> sights;
+    sights.push_back(SunSightFrom(lat, lon, "2024-06-01 10:00:00"));
+    EXPECT_EQ(track.Update(sights, 0), 0);
+    track.Motion(start.GetTicks() + 24 * 3600, 0, 0, false);
+    EXPECT_EQ(track.Update(sights, 0), 1);
+    EXPECT_EQ(track.Update(sights, 0), 0);
+}